@@ -13,6 +13,7 @@
 #include <glm/gtx/vector_angle.hpp>
 
 #include "shaderClass.h"
+#include "Frustum.h"
 
 class Camera
 {
@@ -22,6 +23,8 @@ public:
 	glm::vec3 Orientation = glm::vec3(0.0f, 0.0f, -1.0f);
 	glm::vec3 Up = glm::vec3(0.0f, 1.0f, 0.0f);
 	glm::mat4 cameraMatrix = glm::mat4(1.0f);
+	// Planes of the view volume of cameraMatrix, used to skip what's off screen
+	Frustum frustum;
 
 	// Stores the width and height of the window
 	int width;
@@ -37,6 +40,8 @@ public:
 	void updateMatrix(float FOVdeg, float nearPlane, float farPlane);
 	// Exports the camera matrix to a shader
 	void Matrix(Shader &shader, const char *uniform);
+	// Exports the camera matrix through a cached uniform handle
+	void Matrix(Uniform<glm::mat4>& uniform);
 	// Handles camera inputs
 	void Inputs(GLFWwindow *window);
 };
@@ -61,12 +66,19 @@ void Camera::updateMatrix(float FOVdeg, float nearPlane, float farPlane)
 
 	// Sets new camera matrix
 	cameraMatrix = projection * view;
+	frustum.Update(cameraMatrix);
 }
 
 void Camera::Matrix(Shader &shader, const char *uniform)
 {
 	// Exports camera matrix
-	glUniformMatrix4fv(glGetUniformLocation(shader.ID, uniform), 1, GL_FALSE, glm::value_ptr(cameraMatrix));
+	glUniformMatrix4fv(shader.GetUniformLocation(uniform), 1, GL_FALSE, glm::value_ptr(cameraMatrix));
+}
+
+void Camera::Matrix(Uniform<glm::mat4>& uniform)
+{
+	// Exports camera matrix (skipped by the handle if the camera didn't move)
+	uniform.Set(cameraMatrix);
 }
 
 void Camera::Inputs(GLFWwindow* window)
@@ -0,0 +1,137 @@
+#ifndef CAMERA_PATH_CLASS_H
+#define CAMERA_PATH_CLASS_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+#include "Camera.h"
+
+// Camera pose at a given time of a CameraPath
+struct CameraKeyframe
+{
+	float time;
+	glm::vec3 position;
+	// Point the camera looks at
+	glm::vec3 target;
+};
+
+// Scripted camera motion: keyframes read from a text file, joined by a Catmull-Rom spline so the camera
+// goes through every keyframe without corners. One keyframe per line, in increasing time:
+//   time  x y z  targetX targetY targetZ
+// Empty lines and everything after a # are ignored.
+class CameraPath
+{
+public:
+	std::vector<CameraKeyframe> keyframes;
+
+	// Reads the keyframes from a file, printing the first error it finds
+	bool Load(const std::string& path);
+	// Time of the last keyframe
+	float Duration() const;
+	// Pose at a time; before the first and after the last keyframe the camera holds still
+	CameraKeyframe Sample(float time) const;
+	// Moves a camera to the pose at a time
+	void Apply(Camera& camera, float time) const;
+private:
+	// Uniform Catmull-Rom interpolation between p1 and p2
+	static glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float u);
+};
+
+
+// Reads the keyframes from a file, printing the first error it finds
+bool CameraPath::Load(const std::string& path)
+{
+	std::ifstream in(path);
+	if (!in)
+	{
+		std::cerr << "Could not open camera path: " << path << std::endl;
+		return false;
+	}
+
+	keyframes.clear();
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(in, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream fields(line);
+		CameraKeyframe key;
+		if (!(fields >> key.time))
+			continue;
+		if (!(fields >> key.position.x >> key.position.y >> key.position.z >> key.target.x >> key.target.y >> key.target.z))
+		{
+			std::cerr << path << ":" << lineNumber << ": expected time x y z targetX targetY targetZ" << std::endl;
+			return false;
+		}
+		if (!keyframes.empty() && key.time <= keyframes.back().time)
+		{
+			std::cerr << path << ":" << lineNumber << ": keyframe times must increase" << std::endl;
+			return false;
+		}
+		keyframes.push_back(key);
+	}
+
+	if (keyframes.empty())
+	{
+		std::cerr << path << ": no keyframes" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Time of the last keyframe
+float CameraPath::Duration() const
+{
+	return keyframes.empty() ? 0.0f : keyframes.back().time;
+}
+
+// Pose at a time; before the first and after the last keyframe the camera holds still
+CameraKeyframe CameraPath::Sample(float time) const
+{
+	if (time <= keyframes.front().time)
+		return keyframes.front();
+	if (time >= keyframes.back().time)
+		return keyframes.back();
+
+	// Segment between keyframes i and i + 1; the ends repeat to get the outer control points
+	size_t i = 0;
+	while (keyframes[i + 1].time <= time)
+		i++;
+	const CameraKeyframe& k0 = keyframes[i > 0 ? i - 1 : i];
+	const CameraKeyframe& k1 = keyframes[i];
+	const CameraKeyframe& k2 = keyframes[i + 1];
+	const CameraKeyframe& k3 = keyframes[i + 2 < keyframes.size() ? i + 2 : i + 1];
+	float u = (time - k1.time) / (k2.time - k1.time);
+
+	CameraKeyframe pose;
+	pose.time = time;
+	pose.position = catmullRom(k0.position, k1.position, k2.position, k3.position, u);
+	pose.target = catmullRom(k0.target, k1.target, k2.target, k3.target, u);
+	return pose;
+}
+
+// Moves a camera to the pose at a time
+void CameraPath::Apply(Camera& camera, float time) const
+{
+	CameraKeyframe pose = Sample(time);
+	camera.Position = pose.position;
+	camera.Orientation = glm::normalize(pose.target - pose.position);
+}
+
+// Uniform Catmull-Rom interpolation between p1 and p2
+glm::vec3 CameraPath::catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float u)
+{
+	float u2 = u * u;
+	float u3 = u2 * u;
+	return 0.5f * ((2.0f * p1) + (p2 - p0) * u + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * u2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * u3);
+}
+
+
+#endif
@@ -11,7 +11,8 @@ public:
 	GLuint ID;
 	// Constructor that generates a Elements Buffer Object and links it to indices
 	EBO(const std::vector<GLuint>& indices);
-    EBO(GLuint* indices, GLsizeiptr size);
+    // Constructor that generates a Elements Buffer Object from size bytes of indices read from any memory
+    EBO(const GLuint* indices, GLsizeiptr size);
 
 	// Binds the EBO
 	void Bind();
@@ -22,8 +23,8 @@ public:
 };
 
 
-// Constructor that generates a Elements Buffer Object and links it to indices
-EBO::EBO(GLuint* indices, GLsizeiptr size)
+// Constructor that generates a Elements Buffer Object from size bytes of indices read from any memory
+EBO::EBO(const GLuint* indices, GLsizeiptr size)
 {
     glGenBuffers(1, &ID);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
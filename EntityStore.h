@@ -0,0 +1,229 @@
+#ifndef ENTITY_STORE_CLASS_H
+#define ENTITY_STORE_CLASS_H
+
+#include <vector>
+#include <future>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+// How an entity moves every frame
+enum SwimBehavior
+{
+	SWIM_NONE,          // Doesn't move
+	SWIM_ORBIT,         // Orbits the origin wiggling its tail
+	SWIM_BOB,           // Orbits the origin going up and down
+	SWIM_FIGURE_EIGHT   // Orbits the origin tracing a figure eight
+};
+
+// World matrix of a still object: scaled, placed at position, then rotated (X, Y and Z, in radians) around itself
+glm::mat4 composeWorld(const glm::vec3& position, const glm::vec3& rotation, float scale);
+// Matrix that takes model space normals to world space (inverse transpose of the upper 3x3)
+glm::mat3 normalMatrix(const glm::mat4& world);
+
+// Scene objects as structure of arrays: each component is a contiguous array indexed by entity.
+// Still entities get their matrices once, when they are added, and again only after MarkDirty;
+// Update walks the moving ones and the dirty list, never the rest.
+class EntityStore
+{
+public:
+	// Position in unscaled scene units (the scale is applied before translating, like the rest of the scene)
+	std::vector<glm::vec3> positions;
+	// Rotation around the entity itself, in radians
+	std::vector<glm::vec3> rotations;
+	std::vector<float> scales;
+	std::vector<SwimBehavior> behaviors;
+	// Index of what to draw for each entity, chosen by the caller
+	std::vector<uint32_t> renderables;
+	// World and normal matrix of each entity, up to date after Update
+	std::vector<glm::mat4> worldMatrices;
+	std::vector<glm::mat3> normalMatrices;
+
+	// Adds an entity and returns its index; a moving entity runs its swim `phase` seconds ahead of the clock
+	size_t Add(const glm::vec3& position, const glm::vec3& rotation, float scale, SwimBehavior behavior, uint32_t renderable, float phase = 0.0f);
+	// Number of entities
+	size_t Size() const;
+	// Number of entities that move
+	size_t DynamicCount() const;
+	// Checks if an entity moves every frame
+	bool IsDynamic(size_t entity) const;
+	// Asks for the matrices of a still entity to be rebuilt on the next Update (after changing its position, rotation or scale)
+	void MarkDirty(size_t entity);
+	// Rebuilds the matrices of the dirty still entities, then those of the moving ones for a given time,
+	// split across the threads of the pool
+	void Update(float time, ThreadPool& pool);
+private:
+	// Still entities waiting for new matrices, and a flag per entity so each one is listed once
+	std::vector<uint32_t> dirtyEntities;
+	std::vector<uint8_t> dirtyFlags;
+	// Indices of the moving entities, so Update never touches the still ones
+	std::vector<uint32_t> dynamicEntities;
+	// Per moving entity constants, derived from its position when it's added
+	std::vector<float> headings;
+	std::vector<float> orbitSpeeds;
+	std::vector<float> phases;
+
+	// Computes the world matrices of dynamicEntities[begin, end)
+	void updateRange(size_t begin, size_t end, float time);
+	// Swim motion of a behavior at a time, applied in the entity's own space
+	static glm::mat4 swimMatrix(SwimBehavior behavior, float time);
+};
+
+
+// Fewest moving entities worth handing to another thread
+static const size_t entityChunkSize = 256;
+
+// World matrix of a still object: scaled, placed at position, then rotated (X, Y and Z, in radians) around itself
+glm::mat4 composeWorld(const glm::vec3& position, const glm::vec3& rotation, float scale)
+{
+	glm::mat4 world = glm::translate(glm::scale(glm::mat4(1.0f), glm::vec3(scale)), position);
+	if (rotation.x != 0.0f)
+		world = glm::rotate(world, rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
+	if (rotation.y != 0.0f)
+		world = glm::rotate(world, rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
+	if (rotation.z != 0.0f)
+		world = glm::rotate(world, rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
+	return world;
+}
+
+// Matrix that takes model space normals to world space (inverse transpose of the upper 3x3)
+glm::mat3 normalMatrix(const glm::mat4& world)
+{
+	return glm::transpose(glm::inverse(glm::mat3(world)));
+}
+
+// Adds an entity and returns its index; a moving entity runs its swim `phase` seconds ahead of the clock
+size_t EntityStore::Add(const glm::vec3& position, const glm::vec3& rotation, float scale, SwimBehavior behavior, uint32_t renderable, float phase)
+{
+	size_t entity = positions.size();
+	positions.push_back(position);
+	rotations.push_back(rotation);
+	scales.push_back(scale);
+	behaviors.push_back(behavior);
+	renderables.push_back(renderable);
+	worldMatrices.push_back(composeWorld(position, rotation, scale));
+	normalMatrices.push_back(normalMatrix(worldMatrices.back()));
+	dirtyFlags.push_back(0);
+
+	if (behavior != SWIM_NONE)
+	{
+		// Faces along its orbit: towards its position, then 90 degrees depending on the side of the Z axis
+		float side = position.x > 0.0f ? 1.0f : -1.0f;
+		float distanceToCenter = std::sqrt(position.x * position.x + position.z * position.z);
+		dynamicEntities.push_back((uint32_t)entity);
+		headings.push_back(std::atan2(position.x, position.z) + side * glm::radians(90.0f));
+		orbitSpeeds.push_back(side * 1000.0f / distanceToCenter);
+		phases.push_back(phase);
+	}
+	return entity;
+}
+
+// Number of entities
+size_t EntityStore::Size() const
+{
+	return positions.size();
+}
+
+// Number of entities that move
+size_t EntityStore::DynamicCount() const
+{
+	return dynamicEntities.size();
+}
+
+// Checks if an entity moves every frame
+bool EntityStore::IsDynamic(size_t entity) const
+{
+	return behaviors[entity] != SWIM_NONE;
+}
+
+// Asks for the matrices of a still entity to be rebuilt on the next Update (after changing its position, rotation or scale)
+void EntityStore::MarkDirty(size_t entity)
+{
+	// Moving entities are rebuilt every frame anyway
+	if (IsDynamic(entity) || dirtyFlags[entity])
+		return;
+	dirtyFlags[entity] = 1;
+	dirtyEntities.push_back((uint32_t)entity);
+}
+
+// Rebuilds the matrices of the dirty still entities, then those of the moving ones for a given time,
+// split across the threads of the pool
+void EntityStore::Update(float time, ThreadPool& pool)
+{
+	PROFILE_SCOPE("EntityStore::Update");
+	for (uint32_t entity : dirtyEntities)
+	{
+		worldMatrices[entity] = composeWorld(positions[entity], rotations[entity], scales[entity]);
+		normalMatrices[entity] = normalMatrix(worldMatrices[entity]);
+		dirtyFlags[entity] = 0;
+	}
+	dirtyEntities.clear();
+
+	size_t count = dynamicEntities.size();
+	if (count <= entityChunkSize)
+	{
+		updateRange(0, count, time);
+		return;
+	}
+
+	size_t chunk = std::max(entityChunkSize, count / pool.Size() + 1);
+	std::vector<std::future<void>> jobs;
+	for (size_t begin = 0; begin < count; begin += chunk)
+	{
+		size_t end = std::min(begin + chunk, count);
+		jobs.push_back(pool.Enqueue([this, begin, end, time]() {
+			updateRange(begin, end, time);
+		}));
+	}
+	for (auto& job : jobs)
+		job.get();
+}
+
+// Computes the world matrices of dynamicEntities[begin, end)
+void EntityStore::updateRange(size_t begin, size_t end, float time)
+{
+	for (size_t d = begin; d < end; d++)
+	{
+		uint32_t entity = dynamicEntities[d];
+		// Each entity has its own clock, so the whole school doesn't move in lockstep (same as fish.vert)
+		float t = time + phases[d];
+		glm::mat4 orbit = glm::rotate(glm::mat4(1.0f), t * orbitSpeeds[d], glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 rest = glm::rotate(composeWorld(positions[entity], rotations[entity], scales[entity]), headings[d], glm::vec3(0.0f, 1.0f, 0.0f));
+		worldMatrices[entity] = orbit * rest * swimMatrix(behaviors[entity], t);
+		normalMatrices[entity] = normalMatrix(worldMatrices[entity]);
+	}
+}
+
+// Swim motion of a behavior at a time, applied in the entity's own space
+glm::mat4 EntityStore::swimMatrix(SwimBehavior behavior, float time)
+{
+	if (behavior == SWIM_NONE)
+		return glm::mat4(1.0f);
+
+	float tilt = glm::radians(100.0f * std::sin(time * 20.0f) / 200.0f * 15.0f);
+	// The tail pivots around the head, 300 units in front of the center of the mesh
+	glm::vec3 headOffset(0.0f, 0.0f, -300.0f);
+	glm::mat4 wiggle = glm::translate(glm::rotate(glm::translate(glm::mat4(1.0f), -headOffset), tilt, glm::vec3(0.0f, 1.0f, 0.0f)), headOffset);
+
+	if (behavior == SWIM_BOB)
+	{
+		float bob = 250.0f * std::sin(time * 5.0f);
+		return glm::rotate(glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, bob, 0.0f)),
+			glm::radians(bob / 200.0f * 20.0f), glm::vec3(1.0f, 0.0f, 0.0f)), tilt, glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+	if (behavior == SWIM_FIGURE_EIGHT)
+	{
+		glm::vec3 eight(500.0f * std::sin(2.0f * time), 0.0f, 250.0f * std::cos(4.0f * time));
+		return glm::translate(glm::mat4(1.0f), eight) * wiggle;
+	}
+	return wiggle;
+}
+
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef FBO_CLASS_H
+#define FBO_CLASS_H
+
+//#include<glad/gl.h>
+#include <vector>
+
+class FBO
+{
+public:
+	// Reference ID of the Framebuffer Object
+	GLuint ID;
+	// Renderbuffers it draws into
+	GLuint colorBuffer;
+	GLuint depthBuffer;
+	// Size of both attachments
+	GLsizei width;
+	GLsizei height;
+	// Constructor that generates a Framebuffer Object with an RGBA8 color and a 24 bit depth attachment
+	FBO(GLsizei width, GLsizei height);
+
+	// Checks if the FBO can be drawn to
+	bool Complete();
+	// Copies the color attachment into pixels (RGBA, bottom row first)
+	void ReadPixels(std::vector<unsigned char>& pixels);
+	// Binds the FBO
+	void Bind();
+	// Unbinds the FBO
+	void Unbind();
+	// Deletes the FBO
+	void Delete();
+};
+
+// Constructor that generates a Framebuffer Object with an RGBA8 color and a 24 bit depth attachment
+FBO::FBO(GLsizei width, GLsizei height)
+{
+	FBO::width = width;
+	FBO::height = height;
+
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &ID);
+	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Checks if the FBO can be drawn to
+bool FBO::Complete()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return complete;
+}
+
+// Copies the color attachment into pixels (RGBA, bottom row first)
+void FBO::ReadPixels(std::vector<unsigned char>& pixels)
+{
+	pixels.resize((size_t)width * height * 4);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, ID);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+// Binds the FBO
+void FBO::Bind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+}
+
+// Unbinds the FBO
+void FBO::Unbind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Deletes the FBO
+void FBO::Delete()
+{
+	glDeleteFramebuffers(1, &ID);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+}
+
+
+#endif
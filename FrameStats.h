@@ -0,0 +1,131 @@
+#ifndef FRAME_STATS_CLASS_H
+#define FRAME_STATS_CLASS_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <sys/resource.h>
+
+// Average, percentiles and worst case of a series of frame times
+struct FrameTimeSummary
+{
+	double avg = 0.0;
+	double p50 = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+};
+
+// What a benchmark run drew, stored next to its times so runs of different scenes can be told apart
+struct BenchmarkInfo
+{
+	unsigned int width = 0;
+	unsigned int height = 0;
+	// Placed objects of each kind
+	unsigned int fish = 0;
+	unsigned int rocks = 0;
+	unsigned int corals = 0;
+};
+
+// Frame times of a benchmark run, written out as a report a script can compare between builds
+class FrameStats
+{
+public:
+	// CPU time of each frame in milliseconds
+	std::vector<double> cpu;
+	// GPU time of each frame in milliseconds (GpuTimer::results)
+	std::vector<double> gpu;
+	// Draw calls and triangles of each frame (RenderStats)
+	std::vector<double> drawCalls;
+	std::vector<double> triangles;
+
+	// Summary of a series (nearest-rank percentiles)
+	static FrameTimeSummary Summarize(std::vector<double> samples);
+	// Peak resident memory of the process in megabytes (with a software renderer it includes the GPU buffers)
+	static double PeakMemoryMB();
+	// Writes the summaries to a .json file, or to a .csv file as one row (with a header line)
+	bool WriteReport(const std::string& path, const BenchmarkInfo& info) const;
+};
+
+
+// Summary of a series (nearest-rank percentiles)
+FrameTimeSummary FrameStats::Summarize(std::vector<double> samples)
+{
+	FrameTimeSummary summary;
+	if (samples.empty())
+		return summary;
+
+	std::sort(samples.begin(), samples.end());
+	auto percentile = [&samples](double p) {
+		size_t rank = (size_t)std::ceil(p / 100.0 * samples.size());
+		return samples[std::max<size_t>(rank, 1) - 1];
+	};
+	double total = 0.0;
+	for (double sample : samples)
+		total += sample;
+
+	summary.avg = total / samples.size();
+	summary.p50 = percentile(50.0);
+	summary.p95 = percentile(95.0);
+	summary.p99 = percentile(99.0);
+	summary.max = samples.back();
+	return summary;
+}
+
+// Peak resident memory of the process in megabytes (with a software renderer it includes the GPU buffers)
+double FrameStats::PeakMemoryMB()
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0.0;
+	// ru_maxrss is in kilobytes on Linux
+	return usage.ru_maxrss / 1024.0;
+}
+
+// Writes the summaries to a .json file, or to a .csv file as one row (with a header line)
+bool FrameStats::WriteReport(const std::string& path, const BenchmarkInfo& info) const
+{
+	std::ofstream out(path);
+	if (!out)
+		return false;
+
+	FrameTimeSummary cpuSummary = Summarize(cpu);
+	FrameTimeSummary gpuSummary = Summarize(gpu);
+	double drawCallsAvg = Summarize(drawCalls).avg;
+	double trianglesAvg = Summarize(triangles).avg;
+	double memory = PeakMemoryMB();
+	bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+	if (csv)
+	{
+		// One row per run, so the reports of a sweep can be concatenated under one header
+		out << "frames,width,height,fish,rocks,corals,"
+			"cpu_avg_ms,cpu_p50_ms,cpu_p95_ms,cpu_p99_ms,cpu_max_ms,"
+			"gpu_avg_ms,gpu_p50_ms,gpu_p95_ms,gpu_p99_ms,gpu_max_ms,"
+			"draw_calls,triangles,peak_memory_mb\n";
+		auto columns = [&](const FrameTimeSummary& s) {
+			out << s.avg << "," << s.p50 << "," << s.p95 << "," << s.p99 << "," << s.max << ",";
+		};
+		out << cpu.size() << "," << info.width << "," << info.height << "," << info.fish << "," << info.rocks << "," << info.corals << ",";
+		columns(cpuSummary);
+		columns(gpuSummary);
+		out << drawCallsAvg << "," << trianglesAvg << "," << memory << "\n";
+	}
+	else
+	{
+		auto object = [&](const FrameTimeSummary& s) {
+			out << "{ \"avg\": " << s.avg << ", \"p50\": " << s.p50 << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << " }";
+		};
+		out << "{\n  \"frames\": " << cpu.size() << ",\n  \"width\": " << info.width << ",\n  \"height\": " << info.height
+			<< ",\n  \"scene\": { \"fish\": " << info.fish << ", \"rocks\": " << info.rocks << ", \"corals\": " << info.corals << " }"
+			<< ",\n  \"cpu_ms\": ";
+		object(cpuSummary);
+		out << ",\n  \"gpu_ms\": ";
+		object(gpuSummary);
+		out << ",\n  \"draw_calls\": " << drawCallsAvg << ",\n  \"triangles\": " << trianglesAvg << ",\n  \"peak_memory_mb\": " << memory << "\n}\n";
+	}
+	return (bool)out;
+}
+
+#endif
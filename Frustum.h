@@ -0,0 +1,128 @@
+#ifndef FRUSTUM_CLASS_H
+#define FRUSTUM_CLASS_H
+
+#include <cmath>
+#include <algorithm>
+
+// Bounding volumes of a mesh in its own (model) space
+struct Bounds
+{
+	// Axis aligned box
+	glm::vec3 min = glm::vec3(0.0f);
+	glm::vec3 max = glm::vec3(0.0f);
+	// Sphere around the center of the box that contains every vertex
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+};
+
+// Box in world space that contains the local box of some bounds placed with a model matrix
+void worldBox(const Bounds& bounds, const glm::mat4& model, glm::vec3& min, glm::vec3& max);
+// Bounds (box and sphere) in world space of a mesh placed with a model matrix
+Bounds transformBounds(const Bounds& bounds, const glm::mat4& model);
+
+class Frustum
+{
+public:
+	// Planes as (normal, distance), normals pointing inside: left, right, bottom, top, near, far
+	glm::vec4 planes[6];
+
+	// Extracts the six planes from a projection * view matrix
+	void Update(const glm::mat4& cameraMatrix);
+	// Checks if a sphere in world space touches the frustum
+	bool IntersectsSphere(const glm::vec3& center, float radius) const;
+	// Checks if a world space axis aligned box touches the frustum
+	bool IntersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+	// Checks if a mesh placed with a model matrix may be visible (cheap sphere test first, then its box)
+	bool Intersects(const Bounds& bounds, const glm::mat4& model) const;
+};
+
+
+// Extracts the six planes from a projection * view matrix (Gribb/Hartmann)
+void Frustum::Update(const glm::mat4& cameraMatrix)
+{
+	// glm is column major, so row r is made of the r-th element of every column
+	glm::vec4 rows[4];
+	for (int r = 0; r < 4; r++)
+		rows[r] = glm::vec4(cameraMatrix[0][r], cameraMatrix[1][r], cameraMatrix[2][r], cameraMatrix[3][r]);
+
+	planes[0] = rows[3] + rows[0];
+	planes[1] = rows[3] - rows[0];
+	planes[2] = rows[3] + rows[1];
+	planes[3] = rows[3] - rows[1];
+	planes[4] = rows[3] + rows[2];
+	planes[5] = rows[3] - rows[2];
+
+	// Normalizes so the plane equation gives real distances for the sphere test
+	for (int p = 0; p < 6; p++)
+		planes[p] /= glm::length(glm::vec3(planes[p]));
+}
+
+// Checks if a sphere in world space touches the frustum
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const
+{
+	for (int p = 0; p < 6; p++)
+	{
+		if (glm::dot(glm::vec3(planes[p]), center) + planes[p].w < -radius)
+			return false;
+	}
+	return true;
+}
+
+// Checks if a world space axis aligned box touches the frustum
+bool Frustum::IntersectsBox(const glm::vec3& min, const glm::vec3& max) const
+{
+	for (int p = 0; p < 6; p++)
+	{
+		// Corner of the box furthest along the plane normal
+		glm::vec3 positive(planes[p].x >= 0.0f ? max.x : min.x,
+						   planes[p].y >= 0.0f ? max.y : min.y,
+						   planes[p].z >= 0.0f ? max.z : min.z);
+		if (glm::dot(glm::vec3(planes[p]), positive) + planes[p].w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+// Checks if a mesh placed with a model matrix may be visible (cheap sphere test first, then its box)
+bool Frustum::Intersects(const Bounds& bounds, const glm::mat4& model) const
+{
+	// The sphere grows with the largest scale of the matrix
+	float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	glm::vec3 center = glm::vec3(model * glm::vec4(bounds.center, 1.0f));
+	if (!IntersectsSphere(center, bounds.radius * scale))
+		return false;
+
+	glm::vec3 min, max;
+	worldBox(bounds, model, min, max);
+	return IntersectsBox(min, max);
+}
+
+// Box in world space that contains the local box of some bounds placed with a model matrix (Arvo's method)
+void worldBox(const Bounds& bounds, const glm::mat4& model, glm::vec3& min, glm::vec3& max)
+{
+	glm::vec3 localCenter = (bounds.min + bounds.max) * 0.5f;
+	glm::vec3 localExtent = (bounds.max - bounds.min) * 0.5f;
+	glm::vec3 worldCenter = glm::vec3(model * glm::vec4(localCenter, 1.0f));
+	glm::vec3 worldExtent(0.0f);
+	for (int c = 0; c < 3; c++)
+	{
+		for (int r = 0; r < 3; r++)
+			worldExtent[r] += std::fabs(model[c][r]) * localExtent[c];
+	}
+	min = worldCenter - worldExtent;
+	max = worldCenter + worldExtent;
+}
+
+// Bounds (box and sphere) in world space of a mesh placed with a model matrix
+Bounds transformBounds(const Bounds& bounds, const glm::mat4& model)
+{
+	Bounds world;
+	worldBox(bounds, model, world.min, world.max);
+	float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	world.center = glm::vec3(model * glm::vec4(bounds.center, 1.0f));
+	world.radius = bounds.radius * scale;
+	return world;
+}
+
+
+#endif
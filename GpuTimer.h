@@ -0,0 +1,87 @@
+#ifndef GPU_TIMER_CLASS_H
+#define GPU_TIMER_CLASS_H
+
+//#include<glad/gl.h>
+#include <vector>
+
+// GPU time of each frame through GL_TIME_ELAPSED queries. Results arrive a few frames late, so the queries
+// go round a ring and a query is only read back (blocking if needed) when its slot comes up again.
+class GpuTimer
+{
+public:
+	// GPU time of every finished frame in milliseconds, in frame order
+	std::vector<double> results;
+
+	// Constructor that generates `latency` queries: frames in flight before a read has to wait
+	GpuTimer(int latency = 4);
+
+	// Starts timing a frame
+	void Begin();
+	// Stops timing the frame
+	void End();
+	// Reads back every query still in flight
+	void Flush();
+	// Deletes the queries
+	void Delete();
+private:
+	std::vector<GLuint> queries;
+	std::vector<bool> pending;
+	size_t slot = 0;
+
+	// Reads back one query into results
+	void collect(size_t index);
+};
+
+// Constructor that generates `latency` queries: frames in flight before a read has to wait
+GpuTimer::GpuTimer(int latency)
+{
+	queries.resize(latency);
+	pending.resize(latency, false);
+	glGenQueries(latency, queries.data());
+}
+
+// Starts timing a frame
+void GpuTimer::Begin()
+{
+	if (pending[slot])
+		collect(slot);
+	glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+}
+
+// Stops timing the frame
+void GpuTimer::End()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	pending[slot] = true;
+	slot = (slot + 1) % queries.size();
+}
+
+// Reads back every query still in flight
+void GpuTimer::Flush()
+{
+	// The oldest query is the one in the current slot
+	for (size_t k = 0; k < queries.size(); k++)
+	{
+		size_t index = (slot + k) % queries.size();
+		if (pending[index])
+			collect(index);
+	}
+}
+
+// Deletes the queries
+void GpuTimer::Delete()
+{
+	glDeleteQueries(queries.size(), queries.data());
+}
+
+// Reads back one query into results
+void GpuTimer::collect(size_t index)
+{
+	GLuint64 nanoseconds = 0;
+	glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &nanoseconds);
+	results.push_back(nanoseconds / 1.0e6);
+	pending[index] = false;
+}
+
+
+#endif
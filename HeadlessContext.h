@@ -0,0 +1,196 @@
+#ifndef HEADLESS_CONTEXT_CLASS_H
+#define HEADLESS_CONTEXT_CLASS_H
+
+//#include<glad/gl.h>
+#include <iostream>
+#include <vector>
+
+// OpenGL 3.3 core context without a window or a display, for machines with no X server and no GPU (Mesa's
+// llvmpipe renders on the CPU). It has no default framebuffer worth drawing to: draw into an FBO.
+// Uses EGL on the surfaceless platform; build with HEADLESS_OSMESA to use OSMesa instead.
+// Windows and macOS have neither, and Create always fails there.
+#if defined(_WIN32) || defined(__APPLE__)
+#define HEADLESS_UNAVAILABLE
+#elif defined(HEADLESS_OSMESA)
+#include <GL/osmesa.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#endif
+
+class HeadlessContext
+{
+public:
+	// Creates the context and makes it current on this thread
+	bool Create();
+	// Destroys the context
+	void Destroy();
+
+	// Looks up an OpenGL function, to pass to gladLoadGL
+	static GLADapiproc GetProcAddress(const char* name);
+private:
+#if defined(HEADLESS_UNAVAILABLE)
+#elif defined(HEADLESS_OSMESA)
+	OSMesaContext context = NULL;
+	// OSMesa needs a buffer to make the context current; it is never drawn to
+	std::vector<unsigned char> buffer = std::vector<unsigned char>(4);
+#else
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+#endif
+};
+
+
+#if defined(HEADLESS_UNAVAILABLE)
+
+// Creates the context and makes it current on this thread
+bool HeadlessContext::Create()
+{
+	std::cerr << "Headless rendering needs EGL or OSMesa, which this platform does not have" << std::endl;
+	return false;
+}
+
+// Destroys the context
+void HeadlessContext::Destroy()
+{
+}
+
+// Looks up an OpenGL function, to pass to gladLoadGL
+GLADapiproc HeadlessContext::GetProcAddress(const char* name)
+{
+	return NULL;
+}
+
+#elif defined(HEADLESS_OSMESA)
+
+// Creates the context and makes it current on this thread
+bool HeadlessContext::Create()
+{
+	const int attribs[] = {
+		OSMESA_FORMAT, OSMESA_RGBA,
+		OSMESA_DEPTH_BITS, 24,
+		OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+		OSMESA_CONTEXT_MAJOR_VERSION, 3,
+		OSMESA_CONTEXT_MINOR_VERSION, 3,
+		0
+	};
+	context = OSMesaCreateContextAttribs(attribs, NULL);
+	if (!context)
+	{
+		std::cerr << "Failed to create an OSMesa OpenGL 3.3 context" << std::endl;
+		return false;
+	}
+	if (!OSMesaMakeCurrent(context, buffer.data(), GL_UNSIGNED_BYTE, 1, 1))
+	{
+		std::cerr << "Failed to make the OSMesa context current" << std::endl;
+		Destroy();
+		return false;
+	}
+	return true;
+}
+
+// Destroys the context
+void HeadlessContext::Destroy()
+{
+	if (context)
+		OSMesaDestroyContext(context);
+	context = NULL;
+}
+
+// Looks up an OpenGL function, to pass to gladLoadGL
+GLADapiproc HeadlessContext::GetProcAddress(const char* name)
+{
+	return (GLADapiproc)OSMesaGetProcAddress(name);
+}
+
+#else
+
+// Creates the context and makes it current on this thread
+bool HeadlessContext::Create()
+{
+	// The surfaceless platform needs no display server; plain eglGetDisplay is the fallback for older EGLs
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		std::cerr << "Failed to initialize EGL" << std::endl;
+		display = EGL_NO_DISPLAY;
+		return false;
+	}
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		std::cerr << "EGL does not support desktop OpenGL" << std::endl;
+		Destroy();
+		return false;
+	}
+
+	// The surface type defaults to window, which the surfaceless platform has none of
+	const EGLint configAttribs[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cerr << "No EGL config for desktop OpenGL" << std::endl;
+		Destroy();
+		return false;
+	}
+
+	const EGLint contextAttribs[] = {
+		EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+		EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+		EGL_NONE
+	};
+	context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	if (context == EGL_NO_CONTEXT)
+	{
+		std::cerr << "Failed to create an EGL OpenGL 3.3 context" << std::endl;
+		Destroy();
+		return false;
+	}
+
+	// Current without any surface (EGL_KHR_surfaceless_context)
+	if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+	{
+		std::cerr << "Failed to make the EGL context current" << std::endl;
+		Destroy();
+		return false;
+	}
+	return true;
+}
+
+// Destroys the context
+void HeadlessContext::Destroy()
+{
+	if (display == EGL_NO_DISPLAY)
+		return;
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (context != EGL_NO_CONTEXT)
+		eglDestroyContext(display, context);
+	eglTerminate(display);
+	context = EGL_NO_CONTEXT;
+	display = EGL_NO_DISPLAY;
+}
+
+// Looks up an OpenGL function, to pass to gladLoadGL
+GLADapiproc HeadlessContext::GetProcAddress(const char* name)
+{
+	return (GLADapiproc)eglGetProcAddress(name);
+}
+
+#endif
+
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef MESH_CACHE_CLASS_H
+#define MESH_CACHE_CLASS_H
+
+//#include<glad/gl.h>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <functional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Frustum.h"
+
+// Header of a baked mesh file, followed by the interleaved vertex block and the index block
+struct MeshCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	// Modification time and size of the .obj the cache was baked from
+	int64_t sourceMtime;
+	int64_t sourceSize;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	// Axis aligned box and bounding sphere of the vertex positions
+	float boundsMin[3];
+	float boundsMax[3];
+	float boundsCenter[3];
+	float boundsRadius;
+};
+
+class MeshCache
+{
+public:
+	// Pointers into the mapped file, valid until Close
+	const MeshCacheHeader* header = nullptr;
+	const Vertex* vertices = nullptr;
+	const GLuint* indices = nullptr;
+
+	// Maps the baked file of an .obj if it exists and is up to date with it
+	bool Open(const std::string& objFilePath);
+	// Unmaps the baked file
+	void Close();
+
+	// Bakes the vertices and indices of an .obj into its cache file
+	static bool Write(const std::string& objFilePath, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const Bounds& bounds);
+	// Path of the baked file that belongs to an .obj
+	static std::string CachePath(const std::string& objFilePath);
+	// Bounds stored in the mapped header
+	Bounds GetBounds() const;
+private:
+	void* mapping = nullptr;
+	size_t mappingSize = 0;
+
+	// Reads the modification time and size of the source file
+	static bool sourceStamp(const std::string& objFilePath, int64_t& mtime, int64_t& size);
+};
+
+static const char meshCacheMagic[4] = { 'M', 'S', 'H', 'C' };
+static const uint32_t meshCacheVersion = 2;
+
+
+// Path of the baked file that belongs to an .obj
+std::string MeshCache::CachePath(const std::string& objFilePath)
+{
+	return objFilePath + ".meshcache";
+}
+
+// Reads the modification time and size of the source file
+bool MeshCache::sourceStamp(const std::string& objFilePath, int64_t& mtime, int64_t& size)
+{
+	struct stat info;
+	if (stat(objFilePath.c_str(), &info) != 0)
+		return false;
+	mtime = (int64_t)info.st_mtime;
+	size = (int64_t)info.st_size;
+	return true;
+}
+
+// Maps the baked file of an .obj if it exists and is up to date with it
+bool MeshCache::Open(const std::string& objFilePath)
+{
+	int64_t mtime, size;
+	if (!sourceStamp(objFilePath, mtime, size))
+		return false;
+
+	int fd = open(CachePath(objFilePath).c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(MeshCacheHeader))
+	{
+		close(fd);
+		return false;
+	}
+
+	// The mapping stays valid after closing the descriptor
+	mappingSize = info.st_size;
+	mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		mapping = nullptr;
+		return false;
+	}
+
+	header = (const MeshCacheHeader*)mapping;
+	size_t expectedSize = sizeof(MeshCacheHeader) + header->vertexCount * sizeof(Vertex) + header->indexCount * sizeof(GLuint);
+
+	// Rejects files from another format version, a different source or that were cut short
+	if (memcmp(header->magic, meshCacheMagic, 4) != 0 || header->version != meshCacheVersion ||
+		header->sourceMtime != mtime || header->sourceSize != size || mappingSize != expectedSize)
+	{
+		Close();
+		return false;
+	}
+
+	vertices = (const Vertex*)((const char*)mapping + sizeof(MeshCacheHeader));
+	indices = (const GLuint*)(vertices + header->vertexCount);
+	return true;
+}
+
+// Bounds stored in the mapped header
+Bounds MeshCache::GetBounds() const
+{
+	Bounds bounds;
+	bounds.min = glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]);
+	bounds.max = glm::vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]);
+	bounds.center = glm::vec3(header->boundsCenter[0], header->boundsCenter[1], header->boundsCenter[2]);
+	bounds.radius = header->boundsRadius;
+	return bounds;
+}
+
+// Unmaps the baked file
+void MeshCache::Close()
+{
+	if (mapping)
+		munmap(mapping, mappingSize);
+	mapping = nullptr;
+	mappingSize = 0;
+	header = nullptr;
+	vertices = nullptr;
+	indices = nullptr;
+}
+
+// Bakes the vertices and indices of an .obj into its cache file
+bool MeshCache::Write(const std::string& objFilePath, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const Bounds& bounds)
+{
+	MeshCacheHeader header = {};
+	memcpy(header.magic, meshCacheMagic, 4);
+	header.version = meshCacheVersion;
+	if (!sourceStamp(objFilePath, header.sourceMtime, header.sourceSize))
+		return false;
+	header.vertexCount = vertices.size();
+	header.indexCount = indices.size();
+
+	for (int k = 0; k < 3; k++)
+	{
+		header.boundsMin[k] = bounds.min[k];
+		header.boundsMax[k] = bounds.max[k];
+		header.boundsCenter[k] = bounds.center[k];
+	}
+	header.boundsRadius = bounds.radius;
+
+	// Writes to a temporary file and renames it so a reader never maps a half written cache
+	// (the thread id keeps two loader threads baking the same mesh from sharing the temporary file)
+	std::string cachePath = CachePath(objFilePath);
+	std::string tempPath = cachePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	FILE* file = fopen(tempPath.c_str(), "wb");
+	if (!file)
+		return false;
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && fwrite(vertices.data(), sizeof(Vertex), vertices.size(), file) == vertices.size();
+	ok = ok && fwrite(indices.data(), sizeof(GLuint), indices.size(), file) == indices.size();
+	ok = (fclose(file) == 0) && ok;
+
+	if (!ok || rename(tempPath.c_str(), cachePath.c_str()) != 0)
+	{
+		remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+#endif
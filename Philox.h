@@ -0,0 +1,118 @@
+#ifndef PHILOX_CLASS_H
+#define PHILOX_CLASS_H
+
+#include <cstdint>
+#include <limits>
+
+// Counter-based random generator (Philox4x32-10, Salmon et al. 2011). Each number is a pure function of
+// (seed, stream, position in the stream), so every object can own a stream picked by its id and get the same
+// numbers no matter which thread draws them or in which order. Meets UniformRandomBitGenerator.
+class Philox
+{
+public:
+	typedef uint32_t result_type;
+
+	// Constructor that starts stream `stream` of the sequence `seed`
+	Philox(uint64_t seed, uint64_t stream);
+
+	// Next 32 random bits of the stream
+	result_type operator()();
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+private:
+	uint32_t key[2];
+	// Counter: words 0-1 count blocks, words 2-3 hold the stream
+	uint32_t counter[4];
+	uint32_t block[4];
+	int used = 4;
+
+	// Encrypts the counter into four new words
+	void generate();
+};
+
+// Stream id for object `index` of a kind of object (fish, rock...), so different kinds never share numbers
+uint64_t streamId(uint32_t kind, uint32_t index);
+// Uniform float in [0, 1) from the top 24 bits of one draw, the same on every platform
+template<typename Rng>
+float randomUnit(Rng& rng);
+// Uniform integer in [0, count)
+template<typename Rng>
+uint32_t randomIndex(Rng& rng, uint32_t count);
+
+
+// Constants of Philox4x32
+static const uint32_t philoxM0 = 0xD2511F53;
+static const uint32_t philoxM1 = 0xCD9E8D57;
+static const uint32_t philoxW0 = 0x9E3779B9;
+static const uint32_t philoxW1 = 0xBB67AE85;
+
+// Constructor that starts stream `stream` of the sequence `seed`
+Philox::Philox(uint64_t seed, uint64_t stream)
+{
+	key[0] = (uint32_t)seed;
+	key[1] = (uint32_t)(seed >> 32);
+	counter[0] = 0;
+	counter[1] = 0;
+	counter[2] = (uint32_t)stream;
+	counter[3] = (uint32_t)(stream >> 32);
+}
+
+// Next 32 random bits of the stream
+Philox::result_type Philox::operator()()
+{
+	if (used == 4)
+	{
+		generate();
+		used = 0;
+	}
+	return block[used++];
+}
+
+// Encrypts the counter into four new words
+void Philox::generate()
+{
+	uint32_t x[4] = { counter[0], counter[1], counter[2], counter[3] };
+	uint32_t k0 = key[0], k1 = key[1];
+	for (int round = 0; round < 10; round++)
+	{
+		uint64_t product0 = (uint64_t)philoxM0 * x[0];
+		uint64_t product1 = (uint64_t)philoxM1 * x[2];
+		uint32_t y0 = (uint32_t)(product1 >> 32) ^ x[1] ^ k0;
+		uint32_t y1 = (uint32_t)product1;
+		uint32_t y2 = (uint32_t)(product0 >> 32) ^ x[3] ^ k1;
+		uint32_t y3 = (uint32_t)product0;
+		x[0] = y0; x[1] = y1; x[2] = y2; x[3] = y3;
+		k0 += philoxW0;
+		k1 += philoxW1;
+	}
+	for (int i = 0; i < 4; i++)
+		block[i] = x[i];
+
+	// 64 bit block counter, the stream words never change
+	if (++counter[0] == 0)
+		counter[1]++;
+}
+
+// Stream id for object `index` of a kind of object (fish, rock...), so different kinds never share numbers
+uint64_t streamId(uint32_t kind, uint32_t index)
+{
+	return ((uint64_t)kind << 32) | index;
+}
+
+// Uniform float in [0, 1) from the top 24 bits of one draw, the same on every platform
+template<typename Rng>
+float randomUnit(Rng& rng)
+{
+	return (uint32_t)(rng() >> 8) * (1.0f / 16777216.0f);
+}
+
+// Uniform integer in [0, count)
+template<typename Rng>
+uint32_t randomIndex(Rng& rng, uint32_t count)
+{
+	// Multiply-shift instead of modulo; the bias is below 2^-32 * count, far under what placement can notice
+	return (uint32_t)(((uint64_t)(uint32_t)rng() * count) >> 32);
+}
+
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef POISSON_DISK_CLASS_H
+#define POISSON_DISK_CLASS_H
+
+#include <vector>
+#include <future>
+#include <algorithm>
+#include <cmath>
+
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+#include "Philox.h"
+#include "Profiler.h"
+
+// Region to fill with points: a box, optionally cut down to an annulus around the Y axis.
+// A box with min.y == max.y is flat and is sampled in the XZ plane only.
+struct PoissonDomain
+{
+	glm::vec3 min = glm::vec3(0.0f);
+	glm::vec3 max = glm::vec3(0.0f);
+	// Annulus in XZ around the origin; ignored while outerRadius is 0
+	float innerRadius = 0.0f;
+	float outerRadius = 0.0f;
+
+	// Box domain (a volume, or a plane if both y are equal)
+	static PoissonDomain Box(const glm::vec3& min, const glm::vec3& max);
+	// Flat annulus at height y
+	static PoissonDomain Annulus(float innerRadius, float outerRadius, float y);
+
+	// Checks if the domain is a plane
+	bool Flat() const;
+	// Checks if a point is inside the domain
+	bool Contains(const glm::vec3& point) const;
+	// Area of a flat domain, volume of any other
+	double Measure() const;
+	// Uniform random point inside the domain
+	template<typename Rng>
+	glm::vec3 Sample(Rng& rng) const;
+};
+
+// Bridson's Poisson-disk sampling: fills the domain with points at least minDist apart, trying `attempts`
+// candidates around each point before retiring it. Every accepted point costs at most `attempts` candidates
+// (and every candidate one grid query), so the work is O(attempts * points) however dense the domain gets.
+// With maxPoints > 0 it stops after that many points, so the cost follows the count asked for instead of
+// the size of the domain. The points come back shuffled, so any prefix of them is spread over the whole domain.
+template<typename Rng>
+std::vector<glm::vec3> poissonDisk(const PoissonDomain& domain, float minDist, Rng& rng, int attempts = 30, size_t maxPoints = 0);
+// Bridson's algorithm proper: the points in the order they were accepted (at most maxPoints, if it isn't 0)
+template<typename Rng>
+std::vector<glm::vec3> bridsonFill(const PoissonDomain& domain, float minDist, Rng& rng, int attempts, size_t maxPoints);
+// poissonDisk split into strips along X that are sampled in parallel, strip t with Philox stream (kind, t).
+// The strips are merged in order, dropping points closer than minDist to an earlier strip, so the result
+// depends only on the seed and the domain, never on the number of threads. maxPoints is shared between
+// the strips in proportion to their measure.
+std::vector<glm::vec3> poissonDiskTiled(const PoissonDomain& domain, float minDist, uint64_t seed, uint32_t kind, ThreadPool& pool, int attempts = 30, size_t maxPoints = 0);
+// Fisher-Yates shuffle that only uses randomIndex, so it gives the same order on every standard library
+template<typename Rng>
+void shufflePoints(std::vector<glm::vec3>& points, Rng& rng);
+
+
+// Box domain (a volume, or a plane if both y are equal)
+PoissonDomain PoissonDomain::Box(const glm::vec3& min, const glm::vec3& max)
+{
+	PoissonDomain domain;
+	domain.min = min;
+	domain.max = max;
+	return domain;
+}
+
+// Flat annulus at height y
+PoissonDomain PoissonDomain::Annulus(float innerRadius, float outerRadius, float y)
+{
+	PoissonDomain domain;
+	domain.min = glm::vec3(-outerRadius, y, -outerRadius);
+	domain.max = glm::vec3(outerRadius, y, outerRadius);
+	domain.innerRadius = innerRadius;
+	domain.outerRadius = outerRadius;
+	return domain;
+}
+
+// Checks if the domain is a plane
+bool PoissonDomain::Flat() const
+{
+	return min.y == max.y;
+}
+
+// Checks if a point is inside the domain
+bool PoissonDomain::Contains(const glm::vec3& point) const
+{
+	if (point.x < min.x || point.x > max.x || point.y < min.y || point.y > max.y || point.z < min.z || point.z > max.z)
+		return false;
+	if (outerRadius > 0.0f)
+	{
+		float radiusSquared = point.x * point.x + point.z * point.z;
+		return radiusSquared >= innerRadius * innerRadius && radiusSquared <= outerRadius * outerRadius;
+	}
+	return true;
+}
+
+// Area of a flat domain, volume of any other
+double PoissonDomain::Measure() const
+{
+	double height = Flat() ? 1.0 : (double)max.y - min.y;
+	if (outerRadius <= 0.0f)
+		return ((double)max.x - min.x) * ((double)max.z - min.z) * height;
+
+	// Part of a disc between min.x and max.x (a strip of poissonDiskTiled cuts the annulus along X only)
+	auto discSlice = [this](double radius) {
+		auto integral = [radius](double x) {
+			x = std::max(-radius, std::min(radius, x));
+			return x * std::sqrt(radius * radius - x * x) + radius * radius * std::asin(x / radius);
+		};
+		return integral(max.x) - integral(min.x);
+	};
+	return (discSlice(outerRadius) - discSlice(innerRadius)) * height;
+}
+
+// Uniform random point inside the domain
+template<typename Rng>
+glm::vec3 PoissonDomain::Sample(Rng& rng) const
+{
+	if (outerRadius > 0.0f)
+	{
+		// Square root of a uniform radius squared spreads the points evenly over the area
+		float theta = randomUnit(rng) * 2.0f * (float)M_PI;
+		float radius = std::sqrt(innerRadius * innerRadius + randomUnit(rng) * (outerRadius * outerRadius - innerRadius * innerRadius));
+		glm::vec3 point(radius * std::cos(theta), min.y, radius * std::sin(theta));
+		// The annulus may be cut by a narrower box (a strip of poissonDiskTiled); fall back to the box then
+		if (Contains(point))
+			return point;
+	}
+	float x = randomUnit(rng), y = randomUnit(rng), z = randomUnit(rng);
+	return glm::vec3(min.x + x * (max.x - min.x), min.y + y * (max.y - min.y), min.z + z * (max.z - min.z));
+}
+
+// Bridson's Poisson-disk sampling: fills the domain with points at least minDist apart, trying `attempts`
+// candidates around each point before retiring it. Every accepted point costs at most `attempts` candidates
+// (and every candidate one grid query), so the work is O(attempts * points) however dense the domain gets.
+// With maxPoints > 0 it stops after that many points, so the cost follows the count asked for instead of
+// the size of the domain. The points come back shuffled, so any prefix of them is spread over the whole domain.
+template<typename Rng>
+std::vector<glm::vec3> poissonDisk(const PoissonDomain& domain, float minDist, Rng& rng, int attempts, size_t maxPoints)
+{
+	std::vector<glm::vec3> points = bridsonFill(domain, minDist, rng, attempts, maxPoints);
+	shufflePoints(points, rng);
+	return points;
+}
+
+// Bridson's algorithm proper: the points in the order they were accepted (at most maxPoints, if it isn't 0)
+template<typename Rng>
+std::vector<glm::vec3> bridsonFill(const PoissonDomain& domain, float minDist, Rng& rng, int attempts, size_t maxPoints)
+{
+	PROFILE_SCOPE("bridsonFill");
+	SpatialGrid grid(minDist);
+	std::vector<uint32_t> active;
+	size_t limit = maxPoints > 0 ? maxPoints : SIZE_MAX;
+
+	// A front grown from one seed covers the domain only once it is full. When stopping early, darts thrown
+	// over the whole domain come first, so the points are spread out; the fronts then grow from all of them
+	// if the darts stall before the limit.
+	int failedSeeds = 0;
+	if (maxPoints > 0)
+	{
+		while (failedSeeds < attempts && grid.Size() < limit)
+		{
+			glm::vec3 seed = domain.Sample(rng);
+			if (domain.Contains(seed) && !grid.AnyWithin(seed, minDist))
+			{
+				active.push_back(grid.Insert(seed));
+				failedSeeds = 0;
+			}
+			else
+			{
+				failedSeeds++;
+			}
+		}
+		failedSeeds = 0;
+	}
+
+	// Seeds: one to start, and new ones whenever the front dies out in a part of the domain it can't reach.
+	// Each round of seeding gives up after `attempts` rejected darts, which bounds it as well.
+	while (failedSeeds < attempts && grid.Size() < limit)
+	{
+		glm::vec3 seed = domain.Sample(rng);
+		if (domain.Contains(seed) && !grid.AnyWithin(seed, minDist))
+		{
+			active.push_back(grid.Insert(seed));
+			failedSeeds = 0;
+		}
+		else
+		{
+			failedSeeds++;
+		}
+
+		while (!active.empty() && grid.Size() < limit)
+		{
+			// A random point of the front, so it grows evenly in every direction
+			size_t slot = randomIndex(rng, (uint32_t)active.size());
+			glm::vec3 center = grid.Positions()[active[slot]];
+
+			bool accepted = false;
+			for (int attempt = 0; attempt < attempts && !accepted; attempt++)
+			{
+				// Candidate in the shell between minDist and 2 * minDist around the point
+				float radius = minDist * (1.0f + randomUnit(rng));
+				float theta = randomUnit(rng) * 2.0f * (float)M_PI;
+				glm::vec3 offset;
+				if (domain.Flat())
+				{
+					offset = glm::vec3(std::cos(theta), 0.0f, std::sin(theta));
+				}
+				else
+				{
+					float cosPhi = 2.0f * randomUnit(rng) - 1.0f;
+					float sinPhi = std::sqrt(1.0f - cosPhi * cosPhi);
+					offset = glm::vec3(sinPhi * std::cos(theta), cosPhi, sinPhi * std::sin(theta));
+				}
+				glm::vec3 candidate = center + offset * radius;
+
+				if (domain.Contains(candidate) && !grid.AnyWithin(candidate, minDist))
+				{
+					active.push_back(grid.Insert(candidate));
+					accepted = true;
+				}
+			}
+
+			// Retired once a whole round of candidates around it failed
+			if (!accepted)
+			{
+				active[slot] = active.back();
+				active.pop_back();
+			}
+		}
+	}
+
+	return grid.Positions();
+}
+
+// poissonDisk split into strips along X that are sampled in parallel, strip t with Philox stream (kind, t).
+// The strips are merged in order, dropping points closer than minDist to an earlier strip, so the result
+// depends only on the seed and the domain, never on the number of threads.
+std::vector<glm::vec3> poissonDiskTiled(const PoissonDomain& domain, float minDist, uint64_t seed, uint32_t kind, ThreadPool& pool, int attempts, size_t maxPoints)
+{
+	// Strips about eight points wide: narrower ones would lose too many points at the seams
+	float width = domain.max.x - domain.min.x;
+	int strips = std::max(1, std::min(64, (int)(width / (8.0f * minDist))));
+
+	std::vector<std::future<std::vector<glm::vec3>>> jobs;
+	for (int t = 0; t < strips; t++)
+	{
+		PoissonDomain strip = domain;
+		strip.min.x = domain.min.x + width * t / strips;
+		strip.max.x = domain.min.x + width * (t + 1) / strips;
+		size_t quota = maxPoints > 0 ? std::max<size_t>(1, (size_t)std::ceil(maxPoints * strip.Measure() / domain.Measure())) : 0;
+		jobs.push_back(pool.Enqueue([strip, minDist, seed, kind, t, attempts, quota]() {
+			Philox rng(seed, streamId(kind, t));
+			return bridsonFill(strip, minDist, rng, attempts, quota);
+		}));
+	}
+
+	SpatialGrid merged(minDist);
+	for (auto& job : jobs)
+	{
+		for (const auto& point : job.get())
+		{
+			if (!merged.AnyWithin(point, minDist))
+				merged.Insert(point);
+		}
+	}
+
+	// The stream after the last strip shuffles the merged points
+	std::vector<glm::vec3> points = merged.Positions();
+	Philox rng(seed, streamId(kind, strips));
+	shufflePoints(points, rng);
+	return points;
+}
+
+// Fisher-Yates shuffle that only uses randomIndex, so it gives the same order on every standard library
+template<typename Rng>
+void shufflePoints(std::vector<glm::vec3>& points, Rng& rng)
+{
+	for (size_t i = points.size(); i > 1; i--)
+		std::swap(points[i - 1], points[randomIndex(rng, (uint32_t)i)]);
+}
+
+
+#endif
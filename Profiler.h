@@ -0,0 +1,222 @@
+#ifndef PROFILER_CLASS_H
+#define PROFILER_CLASS_H
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+// One timed scope, in nanoseconds since the profiler started
+struct ProfileEvent
+{
+	const char* name;
+	uint64_t start;
+	uint64_t duration;
+};
+
+// Events of one thread. Only the owning thread writes and it publishes each event by bumping `written`,
+// so recording never takes a lock. When full it wraps around over the oldest events.
+struct ProfileBuffer
+{
+	std::vector<ProfileEvent> events;
+	std::atomic<uint64_t> written{ 0 };
+	uint32_t threadId = 0;
+	std::atomic<const char*> threadName{ nullptr };
+};
+
+// Scoped CPU profiler. Always compiled in; while disabled a scope costs one relaxed atomic load.
+// Scopes can be opened from any thread, each thread writes to its own buffer, and the whole run is
+// exported as Chrome Trace Event JSON (chrome://tracing, Perfetto).
+class Profiler
+{
+public:
+	// Events kept per thread before the oldest are overwritten
+	static const size_t bufferCapacity = 1 << 16;
+
+	// Starts or stops recording; the first Enable sets the time origin of the trace
+	static void Enable(bool enable);
+	// Checks if scopes are being recorded
+	static bool Enabled();
+	// Names the calling thread in the trace (the pointer has to stay valid, use a literal)
+	static void SetThreadName(const char* name);
+	// Adds a finished scope to the calling thread's buffer
+	static void Record(const char* name, uint64_t start, uint64_t end);
+	// Nanoseconds since the time origin
+	static uint64_t Now();
+	// Writes every buffered event as Chrome Trace Event JSON. Call it while the other threads are idle:
+	// an event being written at the same time can come out torn.
+	static bool WriteChromeTrace(const std::string& path);
+private:
+	inline static std::atomic<bool> enabled{ false };
+	inline static std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+	inline static std::mutex registryMutex;
+	inline static std::vector<std::unique_ptr<ProfileBuffer>> buffers;
+
+	// Buffer of the calling thread, registered on its first event
+	static ProfileBuffer* threadBuffer();
+	// Name given with SetThreadName before the thread had a buffer
+	static const char*& pendingThreadName();
+	// Writes a string as a JSON string literal
+	static void writeJSONString(std::ofstream& out, const char* text);
+};
+
+// Records the time between its construction and the end of its scope
+class ProfileScope
+{
+public:
+	// Starts timing (nothing happens if the profiler is disabled)
+	ProfileScope(const char* name);
+	// Records the scope
+	~ProfileScope();
+private:
+	const char* name;
+	uint64_t start;
+};
+
+// Times the rest of the enclosing scope under a name (a string literal)
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+
+// Starts or stops recording; the first Enable sets the time origin of the trace
+void Profiler::Enable(bool enable)
+{
+	static std::once_flag originSet;
+	if (enable)
+		std::call_once(originSet, []() { origin = std::chrono::steady_clock::now(); });
+	enabled.store(enable, std::memory_order_relaxed);
+}
+
+// Checks if scopes are being recorded
+bool Profiler::Enabled()
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+// Names the calling thread in the trace (the pointer has to stay valid, use a literal)
+void Profiler::SetThreadName(const char* name)
+{
+	pendingThreadName() = name;
+	if (Enabled())
+		threadBuffer()->threadName.store(name, std::memory_order_relaxed);
+}
+
+// Adds a finished scope to the calling thread's buffer
+void Profiler::Record(const char* name, uint64_t start, uint64_t end)
+{
+	ProfileBuffer* buffer = threadBuffer();
+	uint64_t index = buffer->written.load(std::memory_order_relaxed);
+	buffer->events[index % bufferCapacity] = ProfileEvent{ name, start, end - start };
+	buffer->written.store(index + 1, std::memory_order_release);
+}
+
+// Nanoseconds since the time origin
+uint64_t Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+// Writes every buffered event as Chrome Trace Event JSON. Call it while the other threads are idle:
+// an event being written at the same time can come out torn.
+bool Profiler::WriteChromeTrace(const std::string& path)
+{
+	std::ofstream out(path);
+	if (!out)
+		return false;
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	out << "{\"traceEvents\":[\n";
+	bool first = true;
+	for (const auto& buffer : buffers)
+	{
+		const char* threadName = buffer->threadName.load(std::memory_order_relaxed);
+		if (threadName)
+		{
+			out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+			writeJSONString(out, threadName);
+			out << "}}";
+			first = false;
+		}
+
+		// Complete events ("X"), oldest first; only the last bufferCapacity survive a wrap
+		uint64_t written = buffer->written.load(std::memory_order_acquire);
+		uint64_t begin = written > bufferCapacity ? written - bufferCapacity : 0;
+		for (uint64_t index = begin; index < written; index++)
+		{
+			const ProfileEvent& event = buffer->events[index % bufferCapacity];
+			out << (first ? "" : ",\n") << "{\"name\":";
+			writeJSONString(out, event.name);
+			out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}";
+			first = false;
+		}
+	}
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return (bool)out;
+}
+
+// Buffer of the calling thread, registered on its first event
+ProfileBuffer* Profiler::threadBuffer()
+{
+	thread_local ProfileBuffer* buffer = nullptr;
+	if (!buffer)
+	{
+		// The registry owns the buffers, so they outlive their threads and can still be exported
+		std::unique_ptr<ProfileBuffer> created(new ProfileBuffer());
+		created->events.resize(bufferCapacity);
+		created->threadName.store(pendingThreadName(), std::memory_order_relaxed);
+		std::lock_guard<std::mutex> lock(registryMutex);
+		created->threadId = buffers.size() + 1;
+		buffer = created.get();
+		buffers.push_back(std::move(created));
+	}
+	return buffer;
+}
+
+// Name given with SetThreadName before the thread had a buffer
+const char*& Profiler::pendingThreadName()
+{
+	thread_local const char* name = nullptr;
+	return name;
+}
+
+// Writes a string as a JSON string literal
+void Profiler::writeJSONString(std::ofstream& out, const char* text)
+{
+	out << '"';
+	for (const char* c = text; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			out << '\\';
+		out << *c;
+	}
+	out << '"';
+}
+
+// Starts timing (nothing happens if the profiler is disabled)
+ProfileScope::ProfileScope(const char* name)
+{
+	if (Profiler::Enabled())
+	{
+		ProfileScope::name = name;
+		start = Profiler::Now();
+	}
+	else
+	{
+		ProfileScope::name = nullptr;
+	}
+}
+
+// Records the scope
+ProfileScope::~ProfileScope()
+{
+	if (name)
+		Profiler::Record(name, start, Profiler::Now());
+}
+
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef RENDER_QUEUE_CLASS_H
+#define RENDER_QUEUE_CLASS_H
+
+//#include<glad/gl.h>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "shaderClass.h"
+#include "Profiler.h"
+
+// Everything needed to issue one draw call
+struct DrawCommand
+{
+	GLuint shader = 0;
+	GLuint texture = 0;
+	GLuint vao = 0;
+	GLsizei indexCount = 0;
+	// 0 draws with glDrawElements, anything else with glDrawElementsInstanced
+	GLsizei instanceCount = 0;
+	// Model matrix uploaded through modelUniform before drawing (skipped when it's null)
+	glm::mat4 model = glm::mat4(1.0f);
+	Uniform<glm::mat4>* modelUniform = nullptr;
+	// Normal matrix uploaded through normalUniform (skipped when it's null)
+	glm::mat3 normal = glm::mat3(1.0f);
+	Uniform<glm::mat3>* normalUniform = nullptr;
+};
+
+// Counters of the last executed frame
+struct RenderStats
+{
+	unsigned int drawCalls = 0;
+	unsigned long long triangles = 0;
+	unsigned int shaderChanges = 0;
+	unsigned int textureChanges = 0;
+	unsigned int vaoChanges = 0;
+};
+
+class RenderQueue
+{
+public:
+	// Distance that maps to the largest depth value of a key
+	float farPlane = 1000.0f;
+	RenderStats stats;
+
+	// Empties the queue for a new frame
+	void Clear();
+	// Adds a draw; depth is its distance to the camera, used to order it inside its pass
+	void Submit(const DrawCommand& command, bool transparent, float depth);
+	// Sorts the draws by key and issues them with as few state changes as possible
+	void Execute();
+
+	// Builds the 64 bit sort key of a draw
+	static uint64_t MakeKey(bool transparent, GLuint shader, GLuint texture, GLuint vao, uint32_t depth);
+private:
+	std::vector<DrawCommand> commands;
+	// Sort key and index into commands, so sorting moves 16 bytes per draw instead of a whole command
+	std::vector<std::pair<uint64_t, uint32_t>> order;
+
+	// Quantizes a camera distance to 24 bits
+	uint32_t quantizeDepth(float depth) const;
+};
+
+
+// Key layout, from the most significant bit:
+//   opaque:      pass(1) | shader(8) | texture(12) | vao(12) | depth(24)     -> grouped by state, front to back
+//   transparent: pass(1) | inverted depth(24) | shader(8) | texture(12) | vao(12) -> back to front
+// IDs are masked to their field width; a collision only makes grouping less tight, Execute compares the real IDs.
+uint64_t RenderQueue::MakeKey(bool transparent, GLuint shader, GLuint texture, GLuint vao, uint32_t depth)
+{
+	uint64_t state = ((uint64_t)(shader & 0xFF) << 24) | ((uint64_t)(texture & 0xFFF) << 12) | (uint64_t)(vao & 0xFFF);
+	if (!transparent)
+		return (state << 24) | (depth & 0xFFFFFF);
+	uint64_t inverted = 0xFFFFFF - (depth & 0xFFFFFF);
+	return (1ull << 63) | (inverted << 32) | state;
+}
+
+// Quantizes a camera distance to 24 bits
+uint32_t RenderQueue::quantizeDepth(float depth) const
+{
+	float normalized = std::min(std::max(depth / farPlane, 0.0f), 1.0f);
+	return (uint32_t)(normalized * 0xFFFFFF);
+}
+
+// Empties the queue for a new frame
+void RenderQueue::Clear()
+{
+	commands.clear();
+	order.clear();
+}
+
+// Adds a draw; depth is its distance to the camera, used to order it inside its pass
+void RenderQueue::Submit(const DrawCommand& command, bool transparent, float depth)
+{
+	order.push_back({ MakeKey(transparent, command.shader, command.texture, command.vao, quantizeDepth(depth)), (uint32_t)commands.size() });
+	commands.push_back(command);
+}
+
+// Sorts the draws by key and issues them with as few state changes as possible
+void RenderQueue::Execute()
+{
+	{
+		PROFILE_SCOPE("RenderQueue sort");
+		std::sort(order.begin(), order.end());
+	}
+	stats = RenderStats();
+	// Per draw uniform uploads and glDrawElements calls, timed as one block: a scope per draw would cost more than the draw
+	PROFILE_SCOPE("RenderQueue submit");
+
+	// The opaque pass starts with blending off, the first draw sets the rest of the state
+	glDisable(GL_BLEND);
+	bool blending = false;
+	GLuint shader = 0, texture = 0, vao = 0;
+
+	for (const auto& entry : order)
+	{
+		const DrawCommand& command = commands[entry.second];
+
+		// Blending only changes once, when the transparent pass starts
+		bool transparent = (entry.first >> 63) != 0;
+		if (transparent != blending)
+		{
+			if (transparent)
+			{
+				glEnable(GL_BLEND);
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			}
+			else
+			{
+				glDisable(GL_BLEND);
+			}
+			blending = transparent;
+		}
+		if (command.shader != shader)
+		{
+			glUseProgram(command.shader);
+			shader = command.shader;
+			stats.shaderChanges++;
+		}
+		if (command.texture != texture)
+		{
+			glBindTexture(GL_TEXTURE_2D, command.texture);
+			texture = command.texture;
+			stats.textureChanges++;
+		}
+		if (command.vao != vao)
+		{
+			glBindVertexArray(command.vao);
+			vao = command.vao;
+			stats.vaoChanges++;
+		}
+		if (command.modelUniform)
+			command.modelUniform->Set(command.model);
+		if (command.normalUniform)
+			command.normalUniform->Set(command.normal);
+
+		if (command.instanceCount > 0)
+		{
+			glDrawElementsInstanced(GL_TRIANGLES, command.indexCount, GL_UNSIGNED_INT, 0, command.instanceCount);
+			stats.triangles += (unsigned long long)command.indexCount / 3 * command.instanceCount;
+		}
+		else
+		{
+			glDrawElements(GL_TRIANGLES, command.indexCount, GL_UNSIGNED_INT, 0);
+			stats.triangles += command.indexCount / 3;
+		}
+		stats.drawCalls++;
+	}
+}
+
+
+#endif
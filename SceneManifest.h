@@ -0,0 +1,253 @@
+#ifndef SCENE_MANIFEST_CLASS_H
+#define SCENE_MANIFEST_CLASS_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdint>
+
+#include "EntityStore.h"
+
+// Where the copies of a manifest entry go
+enum ManifestPlacement
+{
+	PLACE_FIXED,    // At the position given with at=x,y,z
+	PLACE_FISH,     // Spread through the aquarium volume
+	PLACE_ROCKS,    // Around the edge of the floor, stacked when they land on 2 or 3 rocks
+	PLACE_CORAL     // On top of rocks with nothing above them
+};
+
+// How an entry is blended
+enum ManifestBlend
+{
+	BLEND_OPAQUE,
+	BLEND_ALPHA     // Drawn in the transparent pass, back to front
+};
+
+// One line of the manifest: a mesh with its texture, how many copies and how they are placed and drawn
+struct ManifestEntry
+{
+	std::string mesh;
+	std::string texture;
+	uint32_t count = 1;
+	ManifestPlacement placement = PLACE_FIXED;
+	// Position of a fixed entry
+	glm::vec3 position = glm::vec3(0.0f);
+	// Rotation of every copy around itself, in radians (given in degrees with rotate=x,y,z)
+	glm::vec3 rotation = glm::vec3(0.0f);
+	// Static entries get SWIM_NONE
+	SwimBehavior motion = SWIM_NONE;
+	// The water surface, animated by the wave
+	bool water = false;
+	ManifestBlend blend = BLEND_OPAQUE;
+	// Texture with an alpha channel (.png)
+	bool rgba = false;
+};
+
+// Scene description read from a text file, one entry per line:
+//   mesh texture count placement motion blend [rotate=x,y,z]
+// placement is fish, rocks, coral or at=x,y,z; motion is static, orbit, bob, eight or wave; blend is opaque or alpha.
+// Empty lines and everything after a # are ignored.
+class SceneManifest
+{
+public:
+	std::vector<ManifestEntry> entries;
+	// FNV-1a hash of the file contents, so anything generated from it can tell when it changed
+	uint64_t hash = 0;
+
+	// Reads and checks a manifest file, printing the first error it finds
+	bool Load(const std::string& path);
+	// Total copies of every entry with a given placement
+	uint32_t Count(ManifestPlacement placement) const;
+	// Changes the total copies of a placement, split between its entries in the proportions the file gives
+	// (evenly if they were all 0); the hash changes with it
+	void SetCount(ManifestPlacement placement, uint32_t total);
+private:
+	// Reads three comma separated floats
+	static bool parseVec3(const std::string& text, glm::vec3& value);
+};
+
+
+// Reads three comma separated floats
+bool SceneManifest::parseVec3(const std::string& text, glm::vec3& value)
+{
+	char comma1, comma2;
+	std::istringstream in(text);
+	return (in >> value.x >> comma1 >> value.y >> comma2 >> value.z) && comma1 == ',' && comma2 == ',' && (in >> std::ws).eof();
+}
+
+// Reads and checks a manifest file, printing the first error it finds
+bool SceneManifest::Load(const std::string& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in)
+	{
+		std::cerr << "Could not open scene manifest: " << path << std::endl;
+		return false;
+	}
+	std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	hash = 14695981039346656037ull;
+	for (unsigned char c : contents)
+	{
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+
+	entries.clear();
+	std::istringstream lines(contents);
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(lines, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream fields(line);
+		ManifestEntry entry;
+		std::string placement, motion, blend, option;
+		// Read signed so that a negative count is reported instead of wrapping around
+		long long count;
+		if (!(fields >> entry.mesh))
+			continue;
+		if (!(fields >> entry.texture >> count >> placement >> motion >> blend))
+		{
+			std::cerr << path << ":" << lineNumber << ": expected mesh texture count placement motion blend" << std::endl;
+			return false;
+		}
+		if (count < 0 || count > (long long)UINT32_MAX)
+		{
+			std::cerr << path << ":" << lineNumber << ": count " << count << " out of range" << std::endl;
+			return false;
+		}
+		entry.count = (uint32_t)count;
+
+		if (placement == "fish")
+			entry.placement = PLACE_FISH;
+		else if (placement == "rocks")
+			entry.placement = PLACE_ROCKS;
+		else if (placement == "coral")
+			entry.placement = PLACE_CORAL;
+		else if (placement.compare(0, 3, "at=") == 0 && parseVec3(placement.substr(3), entry.position))
+			entry.placement = PLACE_FIXED;
+		else
+		{
+			std::cerr << path << ":" << lineNumber << ": unknown placement " << placement << std::endl;
+			return false;
+		}
+
+		if (motion == "static")
+			entry.motion = SWIM_NONE;
+		else if (motion == "orbit")
+			entry.motion = SWIM_ORBIT;
+		else if (motion == "bob")
+			entry.motion = SWIM_BOB;
+		else if (motion == "eight")
+			entry.motion = SWIM_FIGURE_EIGHT;
+		else if (motion == "wave")
+			entry.water = true;
+		else
+		{
+			std::cerr << path << ":" << lineNumber << ": unknown motion " << motion << std::endl;
+			return false;
+		}
+
+		if (blend == "opaque")
+			entry.blend = BLEND_OPAQUE;
+		else if (blend == "alpha")
+			entry.blend = BLEND_ALPHA;
+		else
+		{
+			std::cerr << path << ":" << lineNumber << ": unknown blend mode " << blend << std::endl;
+			return false;
+		}
+
+		while (fields >> option)
+		{
+			glm::vec3 degrees;
+			if (option.compare(0, 7, "rotate=") == 0 && parseVec3(option.substr(7), degrees))
+				entry.rotation = glm::vec3(glm::radians(degrees.x), glm::radians(degrees.y), glm::radians(degrees.z));
+			else
+			{
+				std::cerr << path << ":" << lineNumber << ": unknown option " << option << std::endl;
+				return false;
+			}
+		}
+
+		// Fixed entries are placed once; more copies would all land on the same spot
+		if (entry.placement == PLACE_FIXED && entry.count != 1)
+		{
+			std::cerr << path << ":" << lineNumber << ": an at= entry has exactly one copy" << std::endl;
+			return false;
+		}
+
+		// Rocks and corals are drawn as fixed instances, whichever path renders them; only a single
+		// fixed mesh can carry the wave
+		if (entry.placement == PLACE_FISH && entry.water)
+		{
+			std::cerr << path << ":" << lineNumber << ": fish can't use the wave motion" << std::endl;
+			return false;
+		}
+		if ((entry.placement == PLACE_ROCKS || entry.placement == PLACE_CORAL) && (entry.motion != SWIM_NONE || entry.water))
+		{
+			std::cerr << path << ":" << lineNumber << ": rocks and corals are static" << std::endl;
+			return false;
+		}
+
+		std::string extension = entry.texture.substr(entry.texture.find_last_of('.') + 1);
+		entry.rgba = extension == "png" || extension == "PNG";
+		entries.push_back(entry);
+	}
+	return true;
+}
+
+// Total copies of every entry with a given placement
+uint32_t SceneManifest::Count(ManifestPlacement placement) const
+{
+	uint32_t total = 0;
+	for (const auto& entry : entries)
+	{
+		if (entry.placement == placement)
+			total += entry.count;
+	}
+	return total;
+}
+
+// Changes the total copies of a placement, split between its entries in the proportions the file gives
+// (evenly if they were all 0); the hash changes with it
+void SceneManifest::SetCount(ManifestPlacement placement, uint32_t total)
+{
+	std::vector<ManifestEntry*> matching;
+	for (auto& entry : entries)
+	{
+		if (entry.placement == placement)
+			matching.push_back(&entry);
+	}
+	if (matching.empty())
+		return;
+
+	uint64_t oldTotal = Count(placement);
+	uint32_t assigned = 0;
+	for (auto* entry : matching)
+	{
+		entry->count = oldTotal > 0 ? (uint32_t)((uint64_t)total * entry->count / oldTotal) : total / (uint32_t)matching.size();
+		assigned += entry->count;
+	}
+	// What the rounding left goes one by one to the first entries
+	for (size_t k = 0; assigned < total; k = (k + 1) % matching.size(), assigned++)
+		matching[k]->count++;
+
+	uint32_t change[2] = { (uint32_t)placement, total };
+	for (size_t b = 0; b < sizeof(change); b++)
+	{
+		hash ^= ((const unsigned char*)change)[b];
+		hash *= 1099511628211ull;
+	}
+}
+
+
+#endif
@@ -0,0 +1,298 @@
+#ifndef SCENE_SNAPSHOT_CLASS_H
+#define SCENE_SNAPSHOT_CLASS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Header of a scene snapshot, followed by the asset table, the entity table and the string block
+struct SnapshotHeader
+{
+	char magic[4];
+	uint32_t version;
+	// Seed and version of the generator the scene came from, and hash of the scene description it read;
+	// a snapshot of any other is stale
+	uint64_t seed;
+	uint64_t sourceHash;
+	uint32_t layoutVersion;
+	uint32_t assetCount;
+	uint32_t entityCount;
+	uint32_t stringBytes;
+};
+
+// Mesh and texture some entities are drawn with
+struct SnapshotAsset
+{
+	// Offsets of the null terminated paths inside the string block
+	uint32_t mesh;
+	uint32_t texture;
+	// What kind of object it is, as the viewer defines it (fish, rock...)
+	uint32_t group;
+	uint32_t flags;
+};
+
+// Flags of a SnapshotAsset
+static const uint32_t snapshotRGBA = 1;        // Texture with an alpha channel
+static const uint32_t snapshotTransparent = 2; // Drawn with blending
+static const uint32_t snapshotWater = 4;       // Water surface, animated by the wave
+
+// One placed object
+struct SnapshotEntity
+{
+	float position[3];
+	float rotation[3];
+	float scale;
+	// SwimBehavior of the entity
+	uint32_t behavior;
+	// Index into the asset table
+	uint32_t asset;
+};
+
+// Asset as given to Build, before its paths go into the string block
+struct SceneAssetDesc
+{
+	std::string mesh;
+	std::string texture;
+	uint32_t group;
+	uint32_t flags;
+};
+
+// Generated scene (placed entities and the assets they use) kept as one flat block of memory, so it can be
+// written to disk as is and memory-mapped on the next launch instead of placing everything again.
+// Every pointer works the same whether the block came from Build or from a mapped file.
+class SceneSnapshot
+{
+public:
+	// Pointers into the block, valid until Close
+	const SnapshotHeader* header = nullptr;
+	const SnapshotAsset* assets = nullptr;
+	const SnapshotEntity* entities = nullptr;
+
+	// Maps a snapshot file if it exists and was made with this seed, source hash and layout version
+	bool Open(const std::string& path, uint64_t seed, uint64_t sourceHash, uint32_t layoutVersion);
+	// Lays out a freshly generated scene in memory
+	void Build(uint64_t seed, uint64_t sourceHash, uint32_t layoutVersion, const std::vector<SceneAssetDesc>& assetList, const std::vector<SnapshotEntity>& entityList);
+	// Writes the block to a file
+	bool Write(const std::string& path) const;
+	// Releases the block
+	void Close();
+
+	// Number of assets
+	uint32_t AssetCount() const;
+	// Number of entities
+	uint32_t EntityCount() const;
+	// Mesh path of an asset
+	const char* Mesh(uint32_t asset) const;
+	// Texture path of an asset
+	const char* Texture(uint32_t asset) const;
+private:
+	void* mapping = nullptr;
+	size_t mappingSize = 0;
+	std::vector<char> buffer;
+	const char* strings = nullptr;
+
+	// Points the tables into a block, returns false if the block is not a complete snapshot
+	bool attach(const char* data, size_t size);
+};
+
+static const char snapshotMagic[4] = { 'S', 'C', 'N', 'S' };
+static const uint32_t snapshotVersion = 2;
+
+// Fills a SnapshotEntity from glm vectors
+SnapshotEntity snapshotEntity(const glm::vec3& position, const glm::vec3& rotation, float scale, uint32_t behavior, uint32_t asset);
+
+
+// Fills a SnapshotEntity from glm vectors
+SnapshotEntity snapshotEntity(const glm::vec3& position, const glm::vec3& rotation, float scale, uint32_t behavior, uint32_t asset)
+{
+	SnapshotEntity entity;
+	for (int k = 0; k < 3; k++)
+	{
+		entity.position[k] = position[k];
+		entity.rotation[k] = rotation[k];
+	}
+	entity.scale = scale;
+	entity.behavior = behavior;
+	entity.asset = asset;
+	return entity;
+}
+
+// Points the tables into a block, returns false if the block is not a complete snapshot
+bool SceneSnapshot::attach(const char* data, size_t size)
+{
+	if (size < sizeof(SnapshotHeader))
+		return false;
+	header = (const SnapshotHeader*)data;
+	size_t expectedSize = sizeof(SnapshotHeader) + header->assetCount * sizeof(SnapshotAsset) +
+		header->entityCount * sizeof(SnapshotEntity) + header->stringBytes;
+	if (memcmp(header->magic, snapshotMagic, 4) != 0 || header->version != snapshotVersion || size != expectedSize)
+	{
+		header = nullptr;
+		return false;
+	}
+
+	assets = (const SnapshotAsset*)(data + sizeof(SnapshotHeader));
+	entities = (const SnapshotEntity*)(assets + header->assetCount);
+	strings = (const char*)(entities + header->entityCount);
+
+	// Every path has to end inside the string block, and every entity has to name a real asset
+	for (uint32_t a = 0; a < header->assetCount; a++)
+	{
+		if (assets[a].mesh >= header->stringBytes || assets[a].texture >= header->stringBytes)
+			return false;
+	}
+	if (header->stringBytes > 0 && strings[header->stringBytes - 1] != '\0')
+		return false;
+	for (uint32_t e = 0; e < header->entityCount; e++)
+	{
+		if (entities[e].asset >= header->assetCount)
+			return false;
+	}
+	return true;
+}
+
+// Maps a snapshot file if it exists and was made with this seed, source hash and layout version
+bool SceneSnapshot::Open(const std::string& path, uint64_t seed, uint64_t sourceHash, uint32_t layoutVersion)
+{
+	Close();
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SnapshotHeader))
+	{
+		close(fd);
+		return false;
+	}
+
+	// The mapping stays valid after closing the descriptor
+	mappingSize = info.st_size;
+	mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		mapping = nullptr;
+		return false;
+	}
+
+	if (!attach((const char*)mapping, mappingSize) || header->seed != seed || header->sourceHash != sourceHash || header->layoutVersion != layoutVersion)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+// Lays out a freshly generated scene in memory
+void SceneSnapshot::Build(uint64_t seed, uint64_t sourceHash, uint32_t layoutVersion, const std::vector<SceneAssetDesc>& assetList, const std::vector<SnapshotEntity>& entityList)
+{
+	Close();
+
+	// Paths go one after the other, each with its terminator
+	std::string stringBlock;
+	std::vector<SnapshotAsset> assetTable;
+	for (const auto& desc : assetList)
+	{
+		SnapshotAsset asset;
+		asset.mesh = stringBlock.size();
+		stringBlock.append(desc.mesh).push_back('\0');
+		asset.texture = stringBlock.size();
+		stringBlock.append(desc.texture).push_back('\0');
+		asset.group = desc.group;
+		asset.flags = desc.flags;
+		assetTable.push_back(asset);
+	}
+
+	SnapshotHeader head = {};
+	memcpy(head.magic, snapshotMagic, 4);
+	head.version = snapshotVersion;
+	head.seed = seed;
+	head.sourceHash = sourceHash;
+	head.layoutVersion = layoutVersion;
+	head.assetCount = assetTable.size();
+	head.entityCount = entityList.size();
+	head.stringBytes = stringBlock.size();
+
+	buffer.resize(sizeof(SnapshotHeader) + assetTable.size() * sizeof(SnapshotAsset) + entityList.size() * sizeof(SnapshotEntity) + stringBlock.size());
+	char* write = buffer.data();
+	memcpy(write, &head, sizeof(head));
+	write += sizeof(head);
+	memcpy(write, assetTable.data(), assetTable.size() * sizeof(SnapshotAsset));
+	write += assetTable.size() * sizeof(SnapshotAsset);
+	memcpy(write, entityList.data(), entityList.size() * sizeof(SnapshotEntity));
+	write += entityList.size() * sizeof(SnapshotEntity);
+	memcpy(write, stringBlock.data(), stringBlock.size());
+
+	attach(buffer.data(), buffer.size());
+}
+
+// Writes the block to a file
+bool SceneSnapshot::Write(const std::string& path) const
+{
+	if (!header)
+		return false;
+	size_t size = sizeof(SnapshotHeader) + header->assetCount * sizeof(SnapshotAsset) + header->entityCount * sizeof(SnapshotEntity) + header->stringBytes;
+
+	// Writes to a temporary file and renames it so a reader never maps a half written snapshot
+	std::string tempPath = path + ".tmp";
+	FILE* file = fopen(tempPath.c_str(), "wb");
+	if (!file)
+		return false;
+	bool ok = fwrite(header, 1, size, file) == size;
+	ok = (fclose(file) == 0) && ok;
+
+	if (!ok || rename(tempPath.c_str(), path.c_str()) != 0)
+	{
+		remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+// Releases the block
+void SceneSnapshot::Close()
+{
+	if (mapping)
+		munmap(mapping, mappingSize);
+	mapping = nullptr;
+	mappingSize = 0;
+	buffer.clear();
+	header = nullptr;
+	assets = nullptr;
+	entities = nullptr;
+	strings = nullptr;
+}
+
+// Number of assets
+uint32_t SceneSnapshot::AssetCount() const
+{
+	return header ? header->assetCount : 0;
+}
+
+// Number of entities
+uint32_t SceneSnapshot::EntityCount() const
+{
+	return header ? header->entityCount : 0;
+}
+
+// Mesh path of an asset
+const char* SceneSnapshot::Mesh(uint32_t asset) const
+{
+	return strings + assets[asset].mesh;
+}
+
+// Texture path of an asset
+const char* SceneSnapshot::Texture(uint32_t asset) const
+{
+	return strings + assets[asset].texture;
+}
+
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef SPATIAL_GRID_CLASS_H
+#define SPATIAL_GRID_CLASS_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+
+// Uniform grid over 3D points, hashed by cell, so a neighbor query only visits the cells around it
+// instead of every point placed so far
+class SpatialGrid
+{
+public:
+	// Constructor that sets the edge of the cells; queries are cheapest with a radius close to it
+	SpatialGrid(float cellSize);
+
+	// Adds a point and returns its index (points are numbered in insertion order)
+	uint32_t Insert(const glm::vec3& position);
+	// Calls visit(index, position) for every point closer than radius to center, until visit returns false
+	template<typename F>
+	void ForEachWithin(const glm::vec3& center, float radius, F visit) const;
+	// Checks if any point is closer than radius to center
+	bool AnyWithin(const glm::vec3& center, float radius) const;
+
+	// Every point, in insertion order
+	const std::vector<glm::vec3>& Positions() const;
+	// Number of points
+	size_t Size() const;
+private:
+	float cellSize;
+	std::vector<glm::vec3> points;
+	std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+
+	// Cell that holds a coordinate along one axis
+	int cellCoord(float value) const;
+	// Distance along one axis from a coordinate to the nearest side of a cell (0 if it's inside)
+	float cellGap(float value, int cell) const;
+	// Packs the three cell coordinates (21 bits each) into one hash key
+	static uint64_t cellKey(int x, int y, int z);
+};
+
+
+// Constructor that sets the edge of the cells; queries are cheapest with a radius close to it
+SpatialGrid::SpatialGrid(float cellSize)
+{
+	SpatialGrid::cellSize = cellSize;
+}
+
+// Adds a point and returns its index (points are numbered in insertion order)
+uint32_t SpatialGrid::Insert(const glm::vec3& position)
+{
+	uint32_t index = (uint32_t)points.size();
+	points.push_back(position);
+	cells[cellKey(cellCoord(position.x), cellCoord(position.y), cellCoord(position.z))].push_back(index);
+	return index;
+}
+
+// Calls visit(index, position) for every point closer than radius to center, until visit returns false
+template<typename F>
+void SpatialGrid::ForEachWithin(const glm::vec3& center, float radius, F visit) const
+{
+	int minX = cellCoord(center.x - radius), maxX = cellCoord(center.x + radius);
+	int minY = cellCoord(center.y - radius), maxY = cellCoord(center.y + radius);
+	int minZ = cellCoord(center.z - radius), maxZ = cellCoord(center.z + radius);
+	float radiusSquared = radius * radius;
+
+	for (int x = minX; x <= maxX; x++)
+	{
+		float dx = cellGap(center.x, x);
+		for (int y = minY; y <= maxY; y++)
+		{
+			float dy = cellGap(center.y, y);
+			for (int z = minZ; z <= maxZ; z++)
+			{
+				// Corner cells of the range often miss the sphere; skipping them saves the hash lookup
+				float dz = cellGap(center.z, z);
+				if (dx * dx + dy * dy + dz * dz >= radiusSquared)
+					continue;
+				auto cell = cells.find(cellKey(x, y, z));
+				if (cell == cells.end())
+					continue;
+				for (uint32_t index : cell->second)
+				{
+					glm::vec3 offset = points[index] - center;
+					if (glm::dot(offset, offset) < radiusSquared && !visit(index, points[index]))
+						return;
+				}
+			}
+		}
+	}
+}
+
+// Checks if any point is closer than radius to center
+bool SpatialGrid::AnyWithin(const glm::vec3& center, float radius) const
+{
+	bool found = false;
+	ForEachWithin(center, radius, [&found](uint32_t, const glm::vec3&) {
+		found = true;
+		return false;
+	});
+	return found;
+}
+
+// Every point, in insertion order
+const std::vector<glm::vec3>& SpatialGrid::Positions() const
+{
+	return points;
+}
+
+// Number of points
+size_t SpatialGrid::Size() const
+{
+	return points.size();
+}
+
+// Cell that holds a coordinate along one axis
+int SpatialGrid::cellCoord(float value) const
+{
+	return (int)std::floor(value / cellSize);
+}
+
+// Distance along one axis from a coordinate to the nearest side of a cell (0 if it's inside)
+float SpatialGrid::cellGap(float value, int cell) const
+{
+	float low = cell * cellSize;
+	float high = low + cellSize;
+	return value < low ? low - value : (value > high ? value - high : 0.0f);
+}
+
+// Packs the three cell coordinates (21 bits each) into one hash key
+uint64_t SpatialGrid::cellKey(int x, int y, int z)
+{
+	const uint64_t mask = (1ull << 21) - 1;
+	return (((uint64_t)x & mask) << 42) | (((uint64_t)y & mask) << 21) | ((uint64_t)z & mask);
+}
+
+
+#endif
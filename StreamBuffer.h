@@ -0,0 +1,152 @@
+#ifndef STREAM_BUFFER_CLASS_H
+#define STREAM_BUFFER_CLASS_H
+
+//#include<glad/gl.h>
+#include <cstring>
+
+// Buffer for data rewritten every frame. With glBufferStorage it holds three regions that stay persistently
+// mapped and hands out the next one each frame, so the CPU writes one region while the GPU may still be
+// reading the other two; a fence per region guards its reuse. Without it the buffer holds a single region
+// and every Map orphans it, writing to the start of a fresh allocation.
+class StreamBuffer
+{
+public:
+	static const int regionCount = 3;
+
+	// Reference ID of the buffer
+	GLuint ID;
+	// Target the buffer is bound to (GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER...)
+	GLenum target;
+	// Bytes available to each frame
+	GLsizeiptr regionSize;
+	// True if the buffer is persistently mapped, false if it falls back to orphaning
+	bool persistent = false;
+
+	// Constructor that generates the buffer with room for three regions of a given size (one when orphaning)
+	StreamBuffer(GLenum target, GLsizeiptr regionSize);
+
+	// Moves to the next region, waiting for the GPU to finish with it, and returns where to write
+	void* Map();
+	// Ends the writes of this frame's region
+	void Unmap();
+	// Marks the region as in use by the commands issued so far (call after the draws that read it)
+	void Fence();
+	// Byte offset of the current region inside the buffer, for attribute pointers or glBindBufferRange
+	GLintptr Offset() const;
+
+	// Binds the buffer
+	void Bind();
+	// Unbinds the buffer
+	void Unbind();
+	// Deletes the buffer and its fences
+	void Delete();
+private:
+	unsigned char* mapping = nullptr;
+	GLsync fences[regionCount] = { 0, 0, 0 };
+	int current = regionCount - 1;
+};
+
+
+// Constructor that generates the buffer with room for three regions of a given size (one when orphaning)
+StreamBuffer::StreamBuffer(GLenum target, GLsizeiptr regionSize)
+{
+	StreamBuffer::target = target;
+	StreamBuffer::regionSize = regionSize;
+	glGenBuffers(1, &ID);
+	glBindBuffer(target, ID);
+
+#ifdef GL_MAP_PERSISTENT_BIT
+	// glBufferStorage is only there with GL 4.4 or ARB_buffer_storage
+	if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(target, regionSize * regionCount, NULL, flags);
+		mapping = (unsigned char*)glMapBufferRange(target, 0, regionSize * regionCount, flags);
+		persistent = mapping != nullptr;
+	}
+#endif
+
+	if (!persistent)
+		glBufferData(target, regionSize, NULL, GL_STREAM_DRAW);
+
+	glBindBuffer(target, 0);
+}
+
+// Moves to the next region, waiting for the GPU to finish with it, and returns where to write
+void* StreamBuffer::Map()
+{
+	if (!persistent)
+	{
+		// Orphaning: the driver hands out new storage and keeps the old one alive for pending draws
+		glBindBuffer(target, ID);
+		return glMapBufferRange(target, 0, regionSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	}
+
+	current = (current + 1) % regionCount;
+	if (fences[current])
+	{
+		// Normally already signaled: the region was last used two frames ago
+		while (glClientWaitSync(fences[current], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+			;
+		glDeleteSync(fences[current]);
+		fences[current] = 0;
+	}
+	return mapping + current * regionSize;
+}
+
+// Ends the writes of this frame's region
+void StreamBuffer::Unmap()
+{
+	// Coherent persistent mappings need nothing, the fallback has to unmap before drawing
+	if (!persistent)
+	{
+		glUnmapBuffer(target);
+		glBindBuffer(target, 0);
+	}
+}
+
+// Marks the region as in use by the commands issued so far (call after the draws that read it)
+void StreamBuffer::Fence()
+{
+	if (persistent)
+		fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+// Byte offset of the current region inside the buffer, for attribute pointers or glBindBufferRange
+GLintptr StreamBuffer::Offset() const
+{
+	return persistent ? current * regionSize : 0;
+}
+
+// Binds the buffer
+void StreamBuffer::Bind()
+{
+	glBindBuffer(target, ID);
+}
+
+// Unbinds the buffer
+void StreamBuffer::Unbind()
+{
+	glBindBuffer(target, 0);
+}
+
+// Deletes the buffer and its fences
+void StreamBuffer::Delete()
+{
+	for (int i = 0; i < regionCount; i++)
+	{
+		if (fences[i])
+			glDeleteSync(fences[i]);
+		fences[i] = 0;
+	}
+	if (persistent)
+	{
+		glBindBuffer(target, ID);
+		glUnmapBuffer(target);
+		glBindBuffer(target, 0);
+	}
+	glDeleteBuffers(1, &ID);
+}
+
+
+#endif
@@ -9,12 +9,26 @@
 
 #include"shaderClass.h"
 
+// Pixels of an image decoded on the CPU, waiting to be uploaded to a Texture
+struct TextureImage
+{
+	unsigned char* bytes = nullptr;
+	int width = 0;
+	int height = 0;
+	int numColCh = 0;
+};
+
+// Reads an image from a file into memory (safe to call from any thread)
+TextureImage decodeTexture(const char* image);
+
 class Texture
 {
 public:
 	GLuint ID;
 	GLenum type;
 	Texture(const char* image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType);
+	// Uploads an already decoded image and frees its pixels (must run on the GL thread)
+	Texture(TextureImage& image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType);
 
 	// Assigns a texture unit to a texture
 	void texUnit(Shader& shader, const char* uniform, GLuint unit);
@@ -27,21 +41,35 @@ public:
 };
 
 
+TextureImage decodeTexture(const char* image)
+{
+	PROFILE_SCOPE("decodeTexture");
+	TextureImage decoded;
+	// Flips the image so it appears right side up (per thread, so workers don't race on it)
+	stbi_set_flip_vertically_on_load_thread(true);
+	// Reads the image from a file and stores it in bytes
+	decoded.bytes = stbi_load(image, &decoded.width, &decoded.height, &decoded.numColCh, 0);
+
+	if (!decoded.bytes) {
+		std::cerr << "Failed to load texture: " << image << std::endl;
+	}
+	return decoded;
+}
+
 Texture::Texture(const char* image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType)
+{
+	TextureImage decoded = decodeTexture(image);
+	*this = Texture(decoded, texType, slot, format, pixelType);
+}
+
+Texture::Texture(TextureImage& image, GLenum texType, GLenum slot, GLenum format, GLenum pixelType)
 {
 	// Assigns the type of the texture ot the texture object
 	type = texType;
 
 	// Stores the width, height, and the number of color channels of the image
-	int widthImg, heightImg, numColCh;
-	// Flips the image so it appears right side up
-	stbi_set_flip_vertically_on_load(true);
-	// Reads the image from a file and stores it in bytes
-	unsigned char* bytes = stbi_load(image, &widthImg, &heightImg, &numColCh, 0);
-
-	if (!bytes) {
-		std::cerr << "Failed to load texture: " << image << std::endl;
-	}
+	int widthImg = image.width, heightImg = image.height;
+	unsigned char* bytes = image.bytes;
 
 	// Generates an OpenGL texture object
 	glGenTextures(1, &ID);
@@ -68,6 +96,7 @@ Texture::Texture(const char* image, GLenum texType, GLenum slot, GLenum format,
 
 	// Deletes the image data as it is already in the OpenGL Texture object
 	stbi_image_free(bytes);
+	image.bytes = nullptr;
 
 	// Unbinds the OpenGL Texture object so that it can't accidentally be modified
 	glBindTexture(texType, 0);
@@ -76,7 +105,7 @@ Texture::Texture(const char* image, GLenum texType, GLenum slot, GLenum format,
 void Texture::texUnit(Shader& shader, const char* uniform, GLuint unit)
 {
 	// Gets the location of the uniform
-	GLuint texUni = glGetUniformLocation(shader.ID, uniform);
+	GLint texUni = shader.GetUniformLocation(uniform);
 	// Shader needs to be activated before changing the value of a uniform
 	shader.Activate();
 	// Sets the value of the uniform
@@ -0,0 +1,103 @@
+#ifndef THREAD_POOL_CLASS_H
+#define THREAD_POOL_CLASS_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "Profiler.h"
+
+class ThreadPool
+{
+public:
+	// Constructor that starts one worker per hardware thread by default
+	ThreadPool(unsigned int numThreads = std::thread::hardware_concurrency());
+	// Finishes the queued tasks and joins the workers
+	~ThreadPool();
+
+	// Queues a task on the workers and returns a future with its result
+	template<typename F>
+	auto Enqueue(F task) -> std::future<decltype(task())>;
+	// Number of worker threads
+	unsigned int Size() const;
+private:
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool stopping = false;
+
+	// Runs queued tasks until the pool is destroyed
+	void workerLoop();
+};
+
+
+// Constructor that starts one worker per hardware thread by default
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+	// hardware_concurrency may report 0 when it can't tell
+	if (numThreads == 0)
+		numThreads = 1;
+	for (unsigned int i = 0; i < numThreads; i++)
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+// Finishes the queued tasks and joins the workers
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+}
+
+// Queues a task on the workers and returns a future with its result
+template<typename F>
+auto ThreadPool::Enqueue(F task) -> std::future<decltype(task())>
+{
+	// packaged_task is move-only, std::function needs something copyable
+	auto packaged = std::make_shared<std::packaged_task<decltype(task())()>>(std::move(task));
+	std::future<decltype(task())> result = packaged->get_future();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push([packaged]() { (*packaged)(); });
+	}
+	condition.notify_one();
+	return result;
+}
+
+// Number of worker threads
+unsigned int ThreadPool::Size() const
+{
+	return workers.size();
+}
+
+// Runs queued tasks until the pool is destroyed
+void ThreadPool::workerLoop()
+{
+	Profiler::SetThreadName("ThreadPool worker");
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if (stopping && tasks.empty())
+				return;
+			task = std::move(tasks.front());
+			tasks.pop();
+		}
+		task();
+	}
+}
+
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef UBO_CLASS_H
+#define UBO_CLASS_H
+
+//#include<glad/gl.h>
+
+class UBO
+{
+public:
+	// Reference ID of the Uniform Buffer Object
+	GLuint ID;
+	// Binding point every Shader links its uniform block to
+	GLuint binding;
+	// Constructor that generates a Uniform Buffer Object of a given size and attaches it to a binding point
+	UBO(GLsizeiptr size, GLuint binding);
+
+	// Replaces the contents of the UBO
+	void Update(const void* data, GLsizeiptr size);
+	// Binds the UBO
+	void Bind();
+	// Unbinds the UBO
+	void Unbind();
+	// Deletes the UBO
+	void Delete();
+};
+
+// Constructor that generates a Uniform Buffer Object of a given size and attaches it to a binding point
+UBO::UBO(GLsizeiptr size, GLuint binding)
+{
+	UBO::binding = binding;
+	glGenBuffers(1, &ID);
+	glBindBuffer(GL_UNIFORM_BUFFER, ID);
+	glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Replaces the contents of the UBO
+void UBO::Update(const void* data, GLsizeiptr size)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, ID);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Binds the UBO
+void UBO::Bind()
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, ID);
+}
+
+// Unbinds the UBO
+void UBO::Unbind()
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Deletes the UBO
+void UBO::Delete()
+{
+	glDeleteBuffers(1, &ID);
+}
+
+
+#endif
@@ -14,6 +14,8 @@ public:
 
 	// Links a VBO Attribute such as a position or color to the VAO
 	void LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset);
+	// Links a per-instance VBO Attribute (advances once per instance instead of once per vertex)
+	void LinkInstanceAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset);
 	// Binds the VAO
 	void Bind();
 	// Unbinds the VAO
@@ -37,6 +39,13 @@ void VAO::LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type,
 	VBO.Unbind();
 }
 
+// Links a per-instance VBO Attribute (advances once per instance instead of once per vertex)
+void VAO::LinkInstanceAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset)
+{
+	LinkAttrib(VBO, layout, numComponents, type, stride, offset);
+	glVertexAttribDivisor(layout, 1);
+}
+
 // Binds the VAO
 void VAO::Bind()
 {
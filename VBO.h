@@ -13,6 +13,15 @@ public:
 	// Constructor that generates a Vertex Buffer Object and links it to vertices
 	VBO(const std::vector<Vertex>& vertices);
     VBO(GLfloat* vertices, GLfloat size);
+	// Constructor that generates a Vertex Buffer Object and links it to count vertices read from any memory (a mapped file)
+	VBO(const Vertex* vertices, size_t count);
+	// Constructor that generates a Vertex Buffer Object and links it to per-instance transforms
+	VBO(const std::vector<glm::mat4>& transforms);
+	// Constructor that generates an empty Vertex Buffer Object of a given size, to be filled with Update
+	VBO(GLsizeiptr size, GLenum usage);
+
+	// Replaces part of the contents of the VBO
+	void Update(GLintptr offset, GLsizeiptr size, const void* data);
 
 	// Binds the VBO
 	void Bind();
@@ -38,6 +47,38 @@ VBO::VBO(const std::vector<Vertex>& vertices)
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW); // Cargar los datos en el buffer
 }
 
+// Constructor that generates a Vertex Buffer Object and links it to count vertices read from any memory (a mapped file)
+VBO::VBO(const Vertex* vertices, size_t count)
+{
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_ARRAY_BUFFER, ID);
+    glBufferData(GL_ARRAY_BUFFER, count * sizeof(Vertex), vertices, GL_STATIC_DRAW);
+}
+
+// Constructor that generates a Vertex Buffer Object and links it to per-instance transforms
+VBO::VBO(const std::vector<glm::mat4>& transforms)
+{
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_ARRAY_BUFFER, ID);
+    glBufferData(GL_ARRAY_BUFFER, transforms.size() * sizeof(glm::mat4), transforms.data(), GL_STATIC_DRAW);
+}
+
+// Constructor that generates an empty Vertex Buffer Object of a given size, to be filled with Update
+VBO::VBO(GLsizeiptr size, GLenum usage)
+{
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_ARRAY_BUFFER, ID);
+    glBufferData(GL_ARRAY_BUFFER, size, NULL, usage);
+}
+
+// Replaces part of the contents of the VBO
+void VBO::Update(GLintptr offset, GLsizeiptr size, const void* data)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, ID);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 // Binds the VBO
 void VBO::Bind()
 {
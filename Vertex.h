@@ -1,4 +1,5 @@
 #include<iostream>
+#include<cstring>
 //#include<glad/gl.h>
 
 struct Vertex {
@@ -7,3 +8,21 @@ struct Vertex {
     GLfloat texCoord[2];
     GLfloat normal[3];
 };
+
+// Dos vértices son iguales si coinciden posición, color, coordenadas de textura y normal
+inline bool operator==(const Vertex& a, const Vertex& b) {
+    return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+}
+
+// Hash FNV-1a sobre los bytes del vértice, para poder usarlo como clave en un unordered_map
+struct VertexHash {
+    size_t operator()(const Vertex& vertex) const {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+        size_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(Vertex); i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+};
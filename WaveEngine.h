@@ -0,0 +1,193 @@
+#ifndef WAVE_ENGINE_CLASS_H
+#define WAVE_ENGINE_CLASS_H
+
+//#include<glad/gl.h>
+#include <vector>
+#include <future>
+#include <cmath>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "ThreadPool.h"
+#include "StreamBuffer.h"
+#include "Profiler.h"
+
+// Shape of the sine wave: height = amplitude * sin(frequency * (x + z + time * speed))
+struct WaveParams
+{
+	float amplitude;
+	float frequency;
+	float speed;
+};
+
+// Sine approximation used by every path of the kernel so they all give the same heights (max error about 0.0011)
+inline float fastSin(float x);
+// Writes the wave height of the vertices in [begin, end) using the widest SIMD the build allows
+void evaluateWaveHeights(const float* xs, const float* zs, float* heights, size_t begin, size_t end, float time, const WaveParams& wave);
+
+class WaveEngine
+{
+public:
+	// Constructor that splits the mesh positions into x/z streams and links a height stream to the VAO
+	WaveEngine(const std::vector<Vertex>& vertices, VAO& vao, GLuint layout, const WaveParams& wave);
+
+	// Evaluates every height for a given time, split across the threads of the pool
+	void Update(float time, ThreadPool& pool);
+	// Writes the height stream (and only it) into this frame's region of its streaming buffer
+	void Upload();
+	// Marks this frame's region as in use (call after the water has been drawn)
+	void Fence();
+	// Heights of the last Update, one per vertex, for gameplay queries
+	const std::vector<float>& Heights() const;
+	// Deletes the height buffer
+	void Delete();
+private:
+	std::vector<float> xs;
+	std::vector<float> zs;
+	std::vector<float> heights;
+	StreamBuffer heightStream;
+	GLuint vaoID;
+	GLuint layout;
+	WaveParams wave;
+};
+
+
+// Constants of the parabolic sine approximation
+static const float waveInvTwoPi = 0.159154943f;
+static const float waveTwoPi = 6.283185307f;
+static const float waveB = 1.273239545f;   // 4 / pi
+static const float waveC = -0.405284735f;  // -4 / pi^2
+static const float waveP = 0.225f;
+
+// Sine approximation used by every path of the kernel so they all give the same heights (max error about 0.0011)
+inline float fastSin(float x)
+{
+	// Wraps to [-pi, pi]
+	x = x - waveTwoPi * std::nearbyint(x * waveInvTwoPi);
+	float y = waveB * x + waveC * x * std::fabs(x);
+	return waveP * (y * std::fabs(y) - y) + y;
+}
+
+// Writes the wave height of the vertices in [begin, end) using the widest SIMD the build allows
+void evaluateWaveHeights(const float* xs, const float* zs, float* heights, size_t begin, size_t end, float time, const WaveParams& wave)
+{
+	float phase = time * wave.speed;
+	size_t i = begin;
+
+#if defined(__AVX2__)
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	const __m256 vPhase = _mm256_set1_ps(phase);
+	const __m256 vFrequency = _mm256_set1_ps(wave.frequency);
+	const __m256 vAmplitude = _mm256_set1_ps(wave.amplitude);
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 x = _mm256_mul_ps(vFrequency, _mm256_add_ps(_mm256_add_ps(_mm256_loadu_ps(xs + i), _mm256_loadu_ps(zs + i)), vPhase));
+		__m256 turns = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(waveInvTwoPi)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		x = _mm256_sub_ps(x, _mm256_mul_ps(turns, _mm256_set1_ps(waveTwoPi)));
+		__m256 y = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(waveB), x),
+			_mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(waveC), x), _mm256_andnot_ps(signMask, x)));
+		y = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(waveP), _mm256_sub_ps(_mm256_mul_ps(y, _mm256_andnot_ps(signMask, y)), y)), y);
+		_mm256_storeu_ps(heights + i, _mm256_mul_ps(vAmplitude, y));
+	}
+#elif defined(__SSE2__)
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 vPhase = _mm_set1_ps(phase);
+	const __m128 vFrequency = _mm_set1_ps(wave.frequency);
+	const __m128 vAmplitude = _mm_set1_ps(wave.amplitude);
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 x = _mm_mul_ps(vFrequency, _mm_add_ps(_mm_add_ps(_mm_loadu_ps(xs + i), _mm_loadu_ps(zs + i)), vPhase));
+		// SSE2 has no round instruction, the conversion to int rounds to nearest
+		__m128 turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(waveInvTwoPi))));
+		x = _mm_sub_ps(x, _mm_mul_ps(turns, _mm_set1_ps(waveTwoPi)));
+		__m128 y = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(waveB), x),
+			_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(waveC), x), _mm_andnot_ps(signMask, x)));
+		y = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(waveP), _mm_sub_ps(_mm_mul_ps(y, _mm_andnot_ps(signMask, y)), y)), y);
+		_mm_storeu_ps(heights + i, _mm_mul_ps(vAmplitude, y));
+	}
+#endif
+
+	// Remaining vertices (or all of them without SIMD)
+	for (; i < end; i++)
+		heights[i] = wave.amplitude * fastSin(wave.frequency * (xs[i] + zs[i] + phase));
+}
+
+
+// Constructor that splits the mesh positions into x/z streams and links a height stream to the VAO
+WaveEngine::WaveEngine(const std::vector<Vertex>& vertices, VAO& vao, GLuint layout, const WaveParams& wave)
+	: heightStream(GL_ARRAY_BUFFER, vertices.size() * sizeof(float)), vaoID(vao.ID), layout(layout), wave(wave)
+{
+	xs.reserve(vertices.size());
+	zs.reserve(vertices.size());
+	for (const auto& vertex : vertices)
+	{
+		xs.push_back(vertex.position[0]);
+		zs.push_back(vertex.position[2]);
+	}
+	heights.assign(vertices.size(), 0.0f);
+
+	vao.Bind();
+	heightStream.Bind();
+	glVertexAttribPointer(layout, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+	glEnableVertexAttribArray(layout);
+	vao.Unbind();
+	heightStream.Unbind();
+}
+
+// Evaluates every height for a given time, split across the threads of the pool
+void WaveEngine::Update(float time, ThreadPool& pool)
+{
+	PROFILE_SCOPE("WaveEngine::Update");
+	// Chunks are a multiple of 8 so only the last one has a scalar tail
+	size_t count = heights.size();
+	size_t chunk = (count / pool.Size() + 8) & ~(size_t)7;
+	std::vector<std::future<void>> jobs;
+	for (size_t begin = 0; begin < count; begin += chunk)
+	{
+		size_t end = std::min(begin + chunk, count);
+		jobs.push_back(pool.Enqueue([this, begin, end, time]() {
+			evaluateWaveHeights(xs.data(), zs.data(), heights.data(), begin, end, time, wave);
+		}));
+	}
+	for (auto& job : jobs)
+		job.get();
+}
+
+// Writes the height stream (and only it) into this frame's region of its streaming buffer
+void WaveEngine::Upload()
+{
+	PROFILE_SCOPE("WaveEngine::Upload");
+	// heights stays in ordinary memory for gameplay reads, the mapped region is only written
+	void* region = heightStream.Map();
+	memcpy(region, heights.data(), heights.size() * sizeof(float));
+	heightStream.Unmap();
+
+	// Points the height attribute at the region written this frame
+	glBindVertexArray(vaoID);
+	heightStream.Bind();
+	glVertexAttribPointer(layout, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)heightStream.Offset());
+	glBindVertexArray(0);
+	heightStream.Unbind();
+}
+
+// Marks this frame's region as in use (call after the water has been drawn)
+void WaveEngine::Fence()
+{
+	heightStream.Fence();
+}
+
+// Heights of the last Update, one per vertex, for gameplay queries
+const std::vector<float>& WaveEngine::Heights() const
+{
+	return heights;
+}
+
+// Deletes the height buffer
+void WaveEngine::Delete()
+{
+	heightStream.Delete();
+}
+
+
+#endif
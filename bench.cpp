@@ -0,0 +1,290 @@
+// Microbenchmarks de las partes del visor que corren en la CPU: carga de .obj, decodificación de texturas,
+// reglas de colocación, matrices por frame y la ola en la CPU. Incluye main.cpp sin su main, así que mide
+// exactamente las mismas funciones que usa el visor.
+//
+// Se compila junto al visor con el Makefile, con las mismas bibliotecas:
+//   make bench
+// Uso: bench [--samples N] [--filter texto] [--output bench.json]
+// Cada medición se repite en N muestras (15 por defecto) después de una de calentamiento; cada muestra
+// repite la operación las veces necesarias para durar al menos 20 ms. Se informa mediana, MAD, mínimo,
+// máximo, media y desvío por operación.
+
+#define AQUARIUM_NO_MAIN
+#include "main.cpp"
+
+#include <algorithm>
+#include <filesystem>
+
+
+// Resultado de una medición, en nanosegundos por operación
+struct BenchResult {
+    std::string name;
+    // Tamaño del caso (puntos, entidades, vértices...) o 0
+    size_t n = 0;
+    // Bytes procesados por operación, para el rendimiento en MB/s (0 si no aplica)
+    size_t bytes = 0;
+    unsigned int iterations = 0;
+    unsigned int samples = 0;
+    double median = 0.0;
+    double mad = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+};
+
+// Configuración de la corrida
+struct BenchOptions {
+    unsigned int samples = 15;
+    // Duración mínima de una muestra
+    double sampleSeconds = 0.02;
+    std::string filter;
+    std::string outputPath = "bench.json";
+};
+
+// Evita que el compilador descarte un resultado que nadie usa
+volatile size_t benchSink = 0;
+
+// Mide body() y devuelve sus estadísticas; el nombre se salta si no contiene el filtro
+template<typename F>
+bool runBench(const BenchOptions& options, std::vector<BenchResult>& results, const std::string& name, size_t n, size_t bytes, F body) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+        return false;
+    }
+    using Clock = std::chrono::steady_clock;
+
+    // Una llamada de calentamiento que también calibra cuántas repeticiones entran en una muestra
+    auto start = Clock::now();
+    body();
+    double once = std::chrono::duration<double>(Clock::now() - start).count();
+    unsigned int iterations = (unsigned int)std::max(1.0, std::ceil(options.sampleSeconds / std::max(once, 1e-9)));
+
+    std::vector<double> perOp;
+    for (unsigned int s = 0; s < options.samples; s++) {
+        start = Clock::now();
+        for (unsigned int i = 0; i < iterations; i++) {
+            body();
+        }
+        perOp.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations);
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.n = n;
+    result.bytes = bytes;
+    result.iterations = iterations;
+    result.samples = options.samples;
+
+    std::vector<double> sorted = perOp;
+    std::sort(sorted.begin(), sorted.end());
+    auto median = [](const std::vector<double>& values) {
+        size_t half = values.size() / 2;
+        return values.size() % 2 ? values[half] : 0.5 * (values[half - 1] + values[half]);
+    };
+    result.median = median(sorted);
+    result.min = sorted.front();
+    result.max = sorted.back();
+    // Desvío absoluto mediano: no lo mueve una muestra interrumpida por el sistema, al revés que el desvío estándar
+    std::vector<double> deviations;
+    for (double value : sorted) {
+        deviations.push_back(std::abs(value - result.median));
+    }
+    std::sort(deviations.begin(), deviations.end());
+    result.mad = median(deviations);
+    for (double value : perOp) {
+        result.mean += value;
+    }
+    result.mean /= perOp.size();
+    for (double value : perOp) {
+        result.stddev += (value - result.mean) * (value - result.mean);
+    }
+    result.stddev = std::sqrt(result.stddev / perOp.size());
+
+    printf("%-48s %10zu %14.0f ns  +-%-10.0f", name.c_str(), n, result.median, result.mad);
+    if (bytes > 0) {
+        printf(" %8.1f MB/s", bytes / result.median * 1e3);
+    }
+    printf("\n");
+    results.push_back(result);
+    return true;
+}
+
+// Escribe los resultados como un arreglo JSON
+bool writeBenchJSON(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    out << "[\n";
+    for (size_t r = 0; r < results.size(); r++) {
+        const BenchResult& result = results[r];
+        out << "  { \"name\": \"" << result.name << "\", \"n\": " << result.n << ", \"bytes\": " << result.bytes
+            << ", \"iterations\": " << result.iterations << ", \"samples\": " << result.samples
+            << ", \"median_ns\": " << result.median << ", \"mad_ns\": " << result.mad
+            << ", \"min_ns\": " << result.min << ", \"max_ns\": " << result.max
+            << ", \"mean_ns\": " << result.mean << ", \"stddev_ns\": " << result.stddev << " }"
+            << (r + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+    return (bool)out;
+}
+
+// Archivos de Models con alguna de las extensiones, ordenados por nombre
+std::vector<std::string> modelFiles(const std::vector<std::string>& extensions) {
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator("Models")) {
+        std::string extension = entry.path().extension().string();
+        if (std::find(extensions.begin(), extensions.end(), extension) != extensions.end()) {
+            files.push_back(entry.path().generic_string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// Puntos al azar en el anillo de las rocas, siempre los mismos para un stream
+std::vector<glm::vec3> benchPoints(size_t count, uint32_t stream) {
+    Philox rng(sceneSeed, streamId(0xBE7C, stream));
+    PoissonDomain annulus = PoissonDomain::Annulus(1000.0f, 1800.0f, -700.0f);
+    std::vector<glm::vec3> points;
+    for (size_t i = 0; i < count; i++) {
+        points.push_back(annulus.Sample(rng));
+    }
+    return points;
+}
+
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--samples") == 0 && hasValue) {
+            options.samples = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+            options.outputPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--samples N] [--filter text] [--output bench.json]" << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    printf("%-48s %10s %17s\n", "benchmark", "n", "median");
+
+
+    // Parseo de cada .obj con tinyobjloader (loadObj, sin la caché de mallas)
+    for (const auto& path : modelFiles({ ".obj" })) {
+        size_t bytes = std::filesystem::file_size(path);
+        runBench(options, results, "loadObj/" + path, 0, bytes, [&]() {
+            std::vector<Vertex> vertices;
+            std::vector<GLuint> indices;
+            Bounds bounds;
+            loadObj(path, vertices, indices, bounds);
+            benchSink += vertices.size();
+        });
+    }
+
+    // Decodificación de cada textura con stb_image
+    for (const auto& path : modelFiles({ ".jpg", ".jpeg", ".png" })) {
+        size_t bytes = std::filesystem::file_size(path);
+        runBench(options, results, "decodeTexture/" + path, 0, bytes, [&]() {
+            TextureImage image = decodeTexture(path.c_str());
+            benchSink += image.width;
+            stbi_image_free(image.bytes);
+        });
+    }
+
+
+    // Reglas de colocación contra N rocas ya colocadas, con la lista (recorrido completo) y con la grilla;
+    // cada operación son 1000 consultas en puntos al azar
+    const size_t queryCount = 1000;
+    std::vector<glm::vec3> queries = benchPoints(queryCount, 0);
+    for (size_t n : { 100, 1000, 10000, 100000 }) {
+        std::vector<glm::vec3> rocks = benchPoints(n, 1);
+        SpatialGrid grid(200.0f);
+        for (const auto& rock : rocks) {
+            grid.Insert(rock);
+        }
+
+        runBench(options, results, "isFarEnough/vector", n, 0, [&]() {
+            for (const auto& query : queries) {
+                benchSink += isFarEnough(query, rocks, 100.0f);
+            }
+        });
+        runBench(options, results, "isFarEnough/grid", n, 0, [&]() {
+            for (const auto& query : queries) {
+                benchSink += isFarEnough(query, grid, 100.0f);
+            }
+        });
+        runBench(options, results, "findTouchingRocks/vector", n, 0, [&]() {
+            for (const auto& query : queries) {
+                benchSink += findTouchingRocks(query, rocks, 200.0f).size();
+            }
+        });
+        runBench(options, results, "findTouchingRocks/grid", n, 0, [&]() {
+            for (const auto& query : queries) {
+                benchSink += findTouchingRocks(query, grid, 200.0f).size();
+            }
+        });
+    }
+
+
+    // Matrices de modelo de un frame: EntityStore::Update con N entidades que nadan (una de cada
+    // comportamiento), repartidas entre los hilos como en el bucle principal
+    ThreadPool pool;
+    for (size_t n : { 100, 1000, 10000, 100000 }) {
+        EntityStore entities;
+        std::vector<glm::vec3> positions = benchPoints(n, 2);
+        for (size_t e = 0; e < n; e++) {
+            entities.Add(positions[e], glm::vec3(0.0f), sceneScale, (SwimBehavior)(SWIM_ORBIT + e % 3), 0);
+        }
+        float time = 0.0f;
+        runBench(options, results, "EntityStore::Update", n, 0, [&]() {
+            entities.Update(time, pool);
+            time += 1.0f / 60.0f;
+            benchSink += (size_t)entities.worldMatrices[0][3][0];
+        });
+    }
+
+
+    // La ola sobre la superficie del agua: primero solo las cuentas de la CPU, después updateWaveModel
+    // completo, que además sube el VBO y necesita un contexto
+    std::vector<Vertex> waterVertices;
+    std::vector<GLuint> waterIndices;
+    Bounds waterBounds;
+    if (loadMesh("Models/superficie2.obj", waterVertices, waterIndices, waterBounds)) {
+        std::vector<Vertex> displaced = waterVertices;
+        float time = 0.0f;
+        runBench(options, results, "displaceWaveVertices", displaced.size(), 0, [&]() {
+            displaceWaveVertices(displaced, time);
+            time += 1.0f / 60.0f;
+            benchSink += (size_t)displaced[0].position[1];
+        });
+
+        HeadlessContext context;
+        if (context.Create()) {
+            gladLoadGL(HeadlessContext::GetProcAddress);
+            Texture texture("Models/celeste.png", GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
+            Model water(waterVertices, waterIndices, "Models/superficie2.obj", texture);
+            runBench(options, results, "updateWaveModel", water.vertices.size(), water.vertices.size() * sizeof(Vertex), [&]() {
+                updateWaveModel(water, time);
+                time += 1.0f / 60.0f;
+            });
+            // Los objetos de GL se borran mientras el contexto sigue vivo
+            water.vao.Delete();
+            water.vbo.Delete();
+            water.ebo.Delete();
+            texture.Delete();
+            context.Destroy();
+        } else {
+            std::cerr << "Skipping updateWaveModel: no headless OpenGL context" << std::endl;
+        }
+    }
+
+
+    if (!writeBenchJSON(options.outputPath, results)) {
+        std::cerr << "Could not write benchmark results: " << options.outputPath << std::endl;
+        return -1;
+    }
+    std::cout << "Wrote " << results.size() << " results to " << options.outputPath << std::endl;
+    return 0;
+}
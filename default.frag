@@ -0,0 +1,47 @@
+#version 330 core
+
+// Outputs colors in RGBA
+out vec4 FragColor;
+
+
+// Imports the color from the Vertex Shader
+in vec3 color;
+// Imports the texture coordinates from the Vertex Shader
+in vec2 texCoord;
+// Imports the normal from the Vertex Shader
+in vec3 Normal;
+// Imports the current position from the Vertex Shader
+in vec3 crntPos;
+
+// Gets the Texture Unit from the main function
+uniform sampler2D tex0;
+// Per-frame camera and light data, written once per frame by the main function
+layout (std140) uniform Frame
+{
+	mat4 camMatrix;
+	vec4 camPos;
+	vec4 lightColor;
+	vec4 lightPos;
+};
+
+
+void main()
+{
+	// ambient lighting
+	float ambient = 0.20f;
+
+	// diffuse lighting
+	vec3 normal = normalize(Normal);
+	vec3 lightDirection = normalize(lightPos.xyz - crntPos);
+	float diffuse = max(dot(normal, lightDirection), 0.0f);
+
+	// specular lighting
+	float specularLight = 0.50f;
+	vec3 viewDirection = normalize(camPos.xyz - crntPos);
+	vec3 reflectionDirection = reflect(-lightDirection, normal);
+	float specAmount = pow(max(dot(viewDirection, reflectionDirection), 0.0f), 8);
+	float specular = specAmount * specularLight;
+
+	// outputs final color
+	FragColor = texture(tex0, texCoord) * lightColor * (diffuse + ambient + specular);
+}
@@ -0,0 +1,94 @@
+#version 330 core
+
+// Positions/Coordinates
+layout (location = 0) in vec3 aPos;
+// Colors
+layout (location = 1) in vec3 aColor;
+// Texture Coordinates
+layout (location = 2) in vec2 aTex;
+// Normals (not necessarily normalized)
+layout (location = 3) in vec3 aNormal;
+// Per-fish swim parameters (FishInstance in main.cpp)
+// xyz: start position, w: heading around Y
+layout (location = 4) in vec4 aPlacement;
+// x: signed angular speed around the origin, y: phase, z: distance from the head to the center, w: 1 to wiggle the tail, 0 to hold still
+layout (location = 5) in vec4 aOrbit;
+// x: bob amplitude, y: pitch per unit of bob, zw: figure-eight amplitude in x and z
+layout (location = 6) in vec4 aSwim;
+
+
+// Outputs the color for the Fragment Shader
+out vec3 color;
+// Outputs the texture coordinates to the Fragment Shader
+out vec2 texCoord;
+// Outputs the normal for the Fragment Shader
+out vec3 Normal;
+// Outputs the current position for the Fragment Shader
+out vec3 crntPos;
+
+// Per-frame camera and light data, written once per frame by the main function
+layout (std140) uniform Frame
+{
+	mat4 camMatrix;
+	vec4 camPos;
+	vec4 lightColor;
+	vec4 lightPos;
+};
+// Animation clock, in seconds
+uniform float time;
+// Scale applied to the whole scene
+uniform float sceneScale;
+
+
+// Same matrices glm::rotate and glm::translate build (GLSL constructors take columns)
+mat4 rotateX(float angle)
+{
+	float c = cos(angle);
+	float s = sin(angle);
+	return mat4(1.0, 0.0, 0.0, 0.0,  0.0, c, s, 0.0,  0.0, -s, c, 0.0,  0.0, 0.0, 0.0, 1.0);
+}
+
+mat4 rotateY(float angle)
+{
+	float c = cos(angle);
+	float s = sin(angle);
+	return mat4(c, 0.0, -s, 0.0,  0.0, 1.0, 0.0, 0.0,  s, 0.0, c, 0.0,  0.0, 0.0, 0.0, 1.0);
+}
+
+mat4 translate(vec3 offset)
+{
+	mat4 m = mat4(1.0);
+	m[3] = vec4(offset, 1.0);
+	return m;
+}
+
+
+void main()
+{
+	float t = time + aOrbit.y;
+	// Tail wiggle: up to 7.5 degrees around Y, pivoting on the head
+	float tilt = aOrbit.w * radians(100.0 * sin(t * 20.0) / 200.0 * 15.0);
+	// Up and down, pitching the nose with the height
+	float bob = aSwim.x * sin(t * 5.0);
+	// Figure eight in the fish's own plane
+	vec3 eight = vec3(aSwim.z * sin(2.0 * t), 0.0, aSwim.w * cos(4.0 * t));
+
+	mat4 scale = mat4(sceneScale);
+	scale[3][3] = 1.0;
+	mat4 model = rotateY(t * aOrbit.x) * scale * translate(aPlacement.xyz) * rotateY(aPlacement.w)
+		* translate(vec3(0.0, bob, 0.0)) * rotateX(bob * aSwim.y) * translate(eight)
+		* translate(vec3(0.0, 0.0, aOrbit.z)) * rotateY(tilt) * translate(vec3(0.0, 0.0, -aOrbit.z));
+
+	// calculates current position
+	crntPos = vec3(model * vec4(aPos, 1.0f));
+	// Outputs the positions/coordinates of all vertices
+	gl_Position = camMatrix * vec4(crntPos, 1.0);
+
+	// Assigns the colors from the Vertex Data to "color"
+	color = aColor;
+	// Assigns the texture coordinates from the Vertex Data to "texCoord"
+	texCoord = aTex;
+	// Rotates the normal into world space; the scale is uniform, so the upper 3x3 does it
+	// up to a length the fragment shader normalizes away
+	Normal = mat3(model) * aNormal;
+}
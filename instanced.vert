@@ -0,0 +1,48 @@
+#version 330 core
+
+// Positions/Coordinates
+layout (location = 0) in vec3 aPos;
+// Colors
+layout (location = 1) in vec3 aColor;
+// Texture Coordinates
+layout (location = 2) in vec2 aTex;
+// Normals (not necessarily normalized)
+layout (location = 3) in vec3 aNormal;
+// Per-instance model matrix (takes up locations 4, 5, 6 and 7)
+layout (location = 4) in mat4 aInstanceModel;
+
+
+// Outputs the color for the Fragment Shader
+out vec3 color;
+// Outputs the texture coordinates to the Fragment Shader
+out vec2 texCoord;
+// Outputs the normal for the Fragment Shader
+out vec3 Normal;
+// Outputs the current position for the Fragment Shader
+out vec3 crntPos;
+
+// Per-frame camera and light data, written once per frame by the main function
+layout (std140) uniform Frame
+{
+	mat4 camMatrix;
+	vec4 camPos;
+	vec4 lightColor;
+	vec4 lightPos;
+};
+
+
+void main()
+{
+	// calculates current position from the instance transform
+	crntPos = vec3(aInstanceModel * vec4(aPos, 1.0f));
+	// Outputs the positions/coordinates of all vertices
+	gl_Position = camMatrix * vec4(crntPos, 1.0);
+
+	// Assigns the colors from the Vertex Data to "color"
+	color = aColor;
+	// Assigns the texture coordinates from the Vertex Data to "texCoord"
+	texCoord = aTex;
+	// Rotates the normal into world space; the scale is uniform, so the upper 3x3 does it
+	// up to a length the fragment shader normalizes away
+	Normal = mat3(aInstanceModel) * aNormal;
+}
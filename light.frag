@@ -0,0 +1,19 @@
+#version 330 core
+
+// Outputs colors in RGBA
+out vec4 FragColor;
+
+// Per-frame camera and light data, written once per frame by the main function
+layout (std140) uniform Frame
+{
+	mat4 camMatrix;
+	vec4 camPos;
+	vec4 lightColor;
+	vec4 lightPos;
+};
+
+
+void main()
+{
+	FragColor = lightColor;
+}
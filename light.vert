@@ -0,0 +1,22 @@
+#version 330 core
+
+// Positions/Coordinates
+layout (location = 0) in vec3 aPos;
+
+// Imports the model matrix from the main function
+uniform mat4 model;
+// Per-frame camera and light data, written once per frame by the main function
+layout (std140) uniform Frame
+{
+	mat4 camMatrix;
+	vec4 camPos;
+	vec4 lightColor;
+	vec4 lightPos;
+};
+
+
+void main()
+{
+	// Outputs the positions/coordinates of all vertices
+	gl_Position = camMatrix * model * vec4(aPos, 1.0f);
+}
@@ -11,15 +11,36 @@
 
 #include <random>
 #include <unordered_set>
+#include <unordered_map>
 #include <cmath>
+#include <chrono>
+#include <fstream>
+#include <cstring>
 
 #include "Texture.h"
 #include "shaderClass.h"
 #include "Vertex.h"
+#include "MeshCache.h"
 #include "VAO.h"
 #include "VBO.h"
 #include "EBO.h"
+#include "UBO.h"
 #include "Camera.h"
+#include "ThreadPool.h"
+#include "RenderQueue.h"
+#include "WaveEngine.h"
+#include "EntityStore.h"
+#include "SpatialGrid.h"
+#include "Philox.h"
+#include "SceneSnapshot.h"
+#include "PoissonDisk.h"
+#include "SceneManifest.h"
+#include "FBO.h"
+#include "HeadlessContext.h"
+#include "CameraPath.h"
+#include "GpuTimer.h"
+#include "FrameStats.h"
+#include "Profiler.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
@@ -28,6 +49,44 @@
 const unsigned int width = 800;
 const unsigned int height = 600;
 
+// Dibuja rocas y corales con una sola llamada glDrawElementsInstanced por malla
+// en lugar de una copia del Model (y un glDrawElements) por cada instancia.
+const bool instancedRendering = true;
+
+// Anima el agua en el vertex shader (water.vert) a partir de un uniform de tiempo; el VBO de la
+// superficie no se vuelve a subir. Con false se usa updateWaveModel en la CPU.
+const bool gpuWaves = true;
+// Si el agua se simula en la CPU: alturas en un stream aparte, calculadas con SIMD en varios hilos (WaveEngine)
+// y subidas con glBufferSubData. Con false se usa el updateWaveModel escalar original.
+const bool simdWaves = true;
+
+// Parámetros de la ola, compartidos por updateWaveModel y water.vert
+const float waveAmplitude = 100.0f; // Amplitud de las olas
+const float waveFrequency = 0.5f; // Frecuencia de las olas
+const float waveSpeed = 10.0f;     // Velocidad de las olas
+
+// Semilla de la escena: la misma semilla da siempre la misma escena, en cualquier máquina y con cualquier
+// cantidad de hilos, porque cada objeto saca sus números de su propio stream (semilla, tipo, índice).
+const uint64_t sceneSeed = 1;
+// Tipos de objeto de la escena, cada uno con sus propios streams
+enum SceneStream : uint32_t {
+    STREAM_FISH = 1,
+    STREAM_ROCKS,
+    STREAM_CORALS,
+    STREAM_FISH_PHASES
+};
+
+// Paso del reloj fijo del modo benchmark: cada frame avanza la escena 1/60 s sin importar lo que tardó
+const double benchmarkFrameStep = 1.0 / 60.0;
+// Frames que el benchmark dibuja antes de medir, con la cámara quieta al inicio del recorrido: absorben el
+// trabajo que el driver deja para el primer uso (compilar variantes de shaders, subir texturas)
+const unsigned int benchmarkWarmupFrames = 10;
+
+// Anima los peces en el vertex shader (fish.vert): cada especie es un lote instanciado con los parámetros
+// de nado de sus peces en un buffer estático, y la CPU solo sube el reloj en cada frame.
+// Con false cada pez es un Model y su matriz se arma en el bucle principal.
+const bool gpuFish = true;
+
 
 
 
@@ -61,7 +120,8 @@ GLuint lightIndices[] =
 
 
 
-bool loadObj(const std::string& objFilePath, std::vector<Vertex>& vertices, std::vector<GLuint>& indices) {
+bool loadObj(const std::string& objFilePath, std::vector<Vertex>& vertices, std::vector<GLuint>& indices, Bounds& bounds) {
+    PROFILE_SCOPE("loadObj");
     tinyobj::attrib_t attrib;
     std::vector<tinyobj::shape_t> shapes;
     std::vector<tinyobj::material_t> materials;
@@ -83,10 +143,13 @@ bool loadObj(const std::string& objFilePath, std::vector<Vertex>& vertices, std:
         return false;
     }
 
+    // Índice de cada vértice único ya emitido, para soldar las esquinas compartidas entre caras
+    std::unordered_map<Vertex, GLuint, VertexHash> uniqueVertices;
+
     // Procesar los vértices y los índices
     for (const auto& shape : shapes) {
         for (const auto& index : shape.mesh.indices) {
-            Vertex vertex;
+            Vertex vertex = {};
 
             // Posiciones
             vertex.position[0] = attrib.vertices[3 * index.vertex_index + 0];
@@ -109,8 +172,29 @@ bool loadObj(const std::string& objFilePath, std::vector<Vertex>& vertices, std:
             vertex.color[1] = attrib.colors[3 * index.vertex_index + 1];
             vertex.color[2] = attrib.colors[3 * index.vertex_index + 2];
 
-            vertices.push_back(vertex);
-            indices.push_back(indices.size());
+            // Reutilizar el vértice si ya existe uno idéntico
+            auto found = uniqueVertices.find(vertex);
+            if (found == uniqueVertices.end()) {
+                found = uniqueVertices.emplace(vertex, static_cast<GLuint>(vertices.size())).first;
+                vertices.push_back(vertex);
+            }
+            indices.push_back(found->second);
+        }
+    }
+
+    // Volúmenes envolventes para el culling: caja alineada a los ejes y esfera centrada en la caja
+    bounds = Bounds();
+    if (!vertices.empty()) {
+        bounds.min = bounds.max = glm::vec3(vertices[0].position[0], vertices[0].position[1], vertices[0].position[2]);
+        for (const auto& vertex : vertices) {
+            glm::vec3 position(vertex.position[0], vertex.position[1], vertex.position[2]);
+            bounds.min = glm::min(bounds.min, position);
+            bounds.max = glm::max(bounds.max, position);
+        }
+        bounds.center = (bounds.min + bounds.max) * 0.5f;
+        for (const auto& vertex : vertices) {
+            glm::vec3 position(vertex.position[0], vertex.position[1], vertex.position[2]);
+            bounds.radius = std::max(bounds.radius, glm::distance(bounds.center, position));
         }
     }
 
@@ -118,19 +202,81 @@ bool loadObj(const std::string& objFilePath, std::vector<Vertex>& vertices, std:
 }
 
 
+// Malla leída por un hilo de carga, todavía sin subir a la GPU. Si vino de la cache, vertices e indices quedan
+// vacíos y los datos se leen directo del archivo mapeado, que sigue abierto hasta Release.
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+    MeshCache cache;
+    Bounds bounds;
+
+    const Vertex* VertexData() const { return cache.header ? cache.vertices : vertices.data(); }
+    size_t VertexCount() const { return cache.header ? cache.header->vertexCount : vertices.size(); }
+    const GLuint* IndexData() const { return cache.header ? cache.indices : indices.data(); }
+    size_t IndexCount() const { return cache.header ? cache.header->indexCount : indices.size(); }
+    // Cierra el mapeo de la cache, si hay uno; después de subir la malla
+    void Release() { cache.Close(); }
+};
+
+// Carga una malla desde su cache binaria si está al día (sin copiarla: queda mapeada en mesh.cache);
+// si no, parsea el .obj y hornea la cache para la próxima vez.
+bool loadMesh(const std::string& objFilePath, MeshData& mesh) {
+    PROFILE_SCOPE("loadMesh");
+    if (mesh.cache.Open(objFilePath)) {
+        mesh.bounds = mesh.cache.GetBounds();
+        return true;
+    }
+
+    if (!loadObj(objFilePath, mesh.vertices, mesh.indices, mesh.bounds)) {
+        return false;
+    }
+
+    if (!MeshCache::Write(objFilePath, mesh.vertices, mesh.indices, mesh.bounds)) {
+        std::cerr << "Could not write mesh cache: " << MeshCache::CachePath(objFilePath) << std::endl;
+    }
+    return true;
+}
+
+// Lo mismo, pero deja la malla en vectores, para quien necesita modificarla en la CPU
+bool loadMesh(const std::string& objFilePath, std::vector<Vertex>& vertices, std::vector<GLuint>& indices, Bounds& bounds) {
+    MeshData mesh;
+    if (!loadMesh(objFilePath, mesh)) {
+        return false;
+    }
+    if (mesh.cache.header) {
+        vertices.assign(mesh.VertexData(), mesh.VertexData() + mesh.VertexCount());
+        indices.assign(mesh.IndexData(), mesh.IndexData() + mesh.IndexCount());
+    } else {
+        vertices = std::move(mesh.vertices);
+        indices = std::move(mesh.indices);
+    }
+    bounds = mesh.bounds;
+    mesh.Release();
+    return true;
+}
+
+
 
 struct Model {
+    // Copia de los vértices en la CPU, solo en las mallas que se modifican después de subirlas (el agua en la CPU)
     std::vector<Vertex> vertices;
-    std::vector<GLuint> indices;
+    GLsizei indexCount;
     VAO vao;
     VBO vbo;
     EBO ebo;
     std::string ModelName;
     Texture texture;
-
-    Model(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const std::string& modelName, const Texture& texture)
-    : vertices(vertices), indices(indices), texture(texture) ,ModelName(modelName),
-    vao(), vbo(vertices), ebo(indices) {
+    // Se dibuja en la pasada con blending, ordenado de atrás hacia adelante
+    bool transparent = false;
+    // Superficie del agua animada por updateWaveModel
+    bool isWater = false;
+    // Volúmenes envolventes en espacio del modelo, calculados al cargar
+    Bounds bounds;
+
+    // Sube los vértices e índices desde cualquier memoria (por ejemplo un archivo mapeado) sin quedarse con una copia
+    Model(const Vertex* vertexData, size_t vertexCount, const GLuint* indexData, size_t indexCount, const std::string& modelName, const Texture& texture)
+    : indexCount(indexCount), texture(texture) ,ModelName(modelName),
+    vao(), vbo(vertexData, vertexCount), ebo(indexData, indexCount * sizeof(GLuint)) {
         vao.Bind();
         vbo.Bind();
         vao.LinkAttrib(vbo, 0, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, position));
@@ -142,6 +288,288 @@ struct Model {
         vbo.Unbind();
         ebo.Unbind();
     }
+
+    // Sube la malla y se queda con una copia de los vértices para modificarlos en la CPU
+    Model(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const std::string& modelName, const Texture& texture)
+    : Model(vertices.data(), vertices.size(), indices.data(), indices.size(), modelName, texture) {
+        this->vertices = vertices;
+    }
+};
+
+
+// Escala que se aplica a todos los modelos de la escena (y fish.vert a los peces)
+const float sceneScale = 0.01f;
+
+// Parámetros de nado de un pez, leídos por fish.vert como atributos por instancia (ubicaciones 4, 5 y 6).
+// Reproducen las mismas cadenas de rotate/translate que el bucle principal usa para cada comportamiento.
+struct FishInstance {
+    glm::vec4 placement; // xyz: posición inicial, w: giro propio alrededor de Y (radianes)
+    glm::vec4 orbit;     // x: velocidad angular alrededor del origen (con signo), y: fase (segundos), z: distancia de la cabeza al centro, w: 1 si mueve la cola
+    glm::vec4 swim;      // x: amplitud vertical, y: inclinación por unidad de altura (radianes), zw: amplitud del ocho en x y z
+};
+
+// Adelanto del reloj de nado de la entidad `entity` de la instantánea, entre 0 y 2π s (cubre un período del
+// vaivén y del ocho), para que los peces no se muevan todos a la vez. Sale de su propio stream.
+float fishPhase(uint32_t entity) {
+    Philox rng(sceneSeed, streamId(STREAM_FISH_PHASES, entity));
+    return randomUnit(rng) * 2.0f * (float)M_PI;
+}
+
+// Parámetros de un pez en la posición position que nada con el comportamiento behavior
+FishInstance makeFishInstance(const glm::vec3& position, SwimBehavior behavior, float phase) {
+    // Mira en la dirección de la órbita: hacia la posición y luego 90 grados según el lado del eje Z
+    float side = position.x > 0.0f ? 1.0f : -1.0f;
+    float angleTest = atan2(position.x, position.z);
+    float distanceToCenter = sqrt(position.x * position.x + position.z * position.z);
+
+    FishInstance fish;
+    fish.swim = glm::vec4(0.0f);
+    if (behavior == SWIM_NONE) {
+        // Quieto en su lugar y sin girar, igual que una entidad quieta del EntityStore
+        fish.placement = glm::vec4(position, 0.0f);
+        fish.orbit = glm::vec4(0.0f, phase, 0.0f, 0.0f);
+        return fish;
+    }
+    fish.placement = glm::vec4(position, angleTest + side * glm::radians(90.0f));
+    fish.orbit = glm::vec4(side * 1000.0f / distanceToCenter, phase, 0.0f, 1.0f);
+    if (behavior == SWIM_ORBIT || behavior == SWIM_FIGURE_EIGHT) {
+        fish.orbit.z = 300.0f; // La cola gira alrededor de la cabeza
+    }
+    if (behavior == SWIM_BOB) {
+        fish.swim.x = 250.0f;
+        fish.swim.y = glm::radians(20.0f / 200.0f);
+    }
+    if (behavior == SWIM_FIGURE_EIGHT) {
+        fish.swim.z = 500.0f;
+        fish.swim.w = 250.0f;
+    }
+    return fish;
+}
+
+
+// Modelo que se dibuja muchas veces con una sola llamada, usando una matriz por instancia.
+struct InstancedModel {
+    Model model;
+    VBO instanceVBO;
+    GLsizei instanceCount;
+    // Instancias que pasaron el último Cull; son las primeras visibleCount del buffer de instancias
+    GLsizei visibleCount;
+    // Volumen en espacio del mundo que envuelve todas las instancias, para descartar el lote entero
+    Bounds worldBounds;
+    // Peces animados por fish.vert en lugar de matrices fijas
+    bool swimming = false;
+    // Lote de la pasada transparente (blend alpha en el manifiesto)
+    bool transparent = false;
+    // Matriz y volumen de cada instancia quieta, para descartarlas una por una
+    std::vector<glm::mat4> transforms;
+    std::vector<Bounds> instanceBounds;
+    // Índices de las instancias visibles en el último Cull; si no cambian no se vuelve a subir nada
+    std::vector<uint32_t> visibleInstances;
+    std::vector<uint32_t> previousVisible;
+    std::vector<glm::mat4> visibleTransforms;
+
+    InstancedModel(const Model& model, const std::vector<glm::mat4>& transforms)
+    : model(model), instanceVBO(transforms.size() * sizeof(glm::mat4), GL_DYNAMIC_DRAW), instanceCount(transforms.size()),
+      visibleCount(transforms.size()), transforms(transforms) {
+        instanceVBO.Update(0, transforms.size() * sizeof(glm::mat4), transforms.data());
+        for (size_t k = 0; k < transforms.size(); k++) {
+            Bounds instance = transformBounds(model.bounds, transforms[k]);
+            instanceBounds.push_back(instance);
+            previousVisible.push_back(k);
+            worldBounds.min = k == 0 ? instance.min : glm::min(worldBounds.min, instance.min);
+            worldBounds.max = k == 0 ? instance.max : glm::max(worldBounds.max, instance.max);
+        }
+        worldBounds.center = (worldBounds.min + worldBounds.max) * 0.5f;
+        worldBounds.radius = glm::distance(worldBounds.center, worldBounds.max);
+
+        this->model.vao.Bind();
+        // Una mat4 ocupa cuatro atributos vec4, despues de los cuatro del Model (ubicaciones 4 a 7)
+        for (GLuint k = 0; k < 4; k++) {
+            this->model.vao.LinkInstanceAttrib(instanceVBO, 4 + k, 4, GL_FLOAT, sizeof(glm::mat4), (void*)(k * sizeof(glm::vec4)));
+        }
+        this->model.vao.Unbind();
+    }
+
+    InstancedModel(const Model& model, const std::vector<FishInstance>& fish)
+    : model(model), instanceVBO(fish.size() * sizeof(FishInstance), GL_STATIC_DRAW), instanceCount(fish.size()),
+      visibleCount(fish.size()), swimming(true) {
+        instanceVBO.Update(0, fish.size() * sizeof(FishInstance), fish.data());
+
+        // Los peces se mueven: la caja cubre todo el anillo que recorren al girar alrededor del eje Y
+        float meshReach = glm::length(model.bounds.center) + model.bounds.radius;
+        for (size_t k = 0; k < fish.size(); k++) {
+            glm::vec3 start = glm::vec3(fish[k].placement);
+            float reach = glm::length(glm::vec2(start.x, start.z)) + glm::length(glm::vec2(fish[k].swim.z, fish[k].swim.w)) + fish[k].orbit.z + meshReach;
+            float rise = fish[k].swim.x + fish[k].orbit.z + meshReach;
+            glm::vec3 min = glm::vec3(-reach, start.y - rise, -reach) * sceneScale;
+            glm::vec3 max = glm::vec3(reach, start.y + rise, reach) * sceneScale;
+            worldBounds.min = k == 0 ? min : glm::min(worldBounds.min, min);
+            worldBounds.max = k == 0 ? max : glm::max(worldBounds.max, max);
+        }
+        worldBounds.center = (worldBounds.min + worldBounds.max) * 0.5f;
+        worldBounds.radius = glm::distance(worldBounds.center, worldBounds.max);
+
+        this->model.vao.Bind();
+        // Tres vec4 por pez en las ubicaciones 4 a 6
+        for (GLuint k = 0; k < 3; k++) {
+            this->model.vao.LinkInstanceAttrib(instanceVBO, 4 + k, 4, GL_FLOAT, sizeof(FishInstance), (void*)(k * sizeof(glm::vec4)));
+        }
+        this->model.vao.Unbind();
+    }
+
+    // Deja al principio del buffer solo las instancias que tocan el frustum y las cuenta en visibleCount.
+    // Los peces se mueven en fish.vert, así que para ellos solo cuenta la caja del lote entero.
+    void Cull(const Frustum& frustum) {
+        if (swimming) {
+            visibleCount = instanceCount;
+            return;
+        }
+        visibleInstances.clear();
+        for (uint32_t k = 0; k < instanceBounds.size(); k++) {
+            const Bounds& bounds = instanceBounds[k];
+            if (frustum.IntersectsSphere(bounds.center, bounds.radius) && frustum.IntersectsBox(bounds.min, bounds.max)) {
+                visibleInstances.push_back(k);
+            }
+        }
+        visibleCount = visibleInstances.size();
+        if (visibleInstances == previousVisible) {
+            return;
+        }
+        visibleTransforms.clear();
+        for (uint32_t k : visibleInstances) {
+            visibleTransforms.push_back(transforms[k]);
+        }
+        if (!visibleTransforms.empty()) {
+            instanceVBO.Update(0, visibleTransforms.size() * sizeof(glm::mat4), visibleTransforms.data());
+        }
+        previousVisible.swap(visibleInstances);
+    }
+};
+
+
+// Handles de los uniforms propios de cada programa; los que un programa no usa quedan en -1 y Set no hace nada.
+// La cámara y la luz no están aquí: van en el bloque Frame (FrameBlock), compartido por todos los programas.
+struct SceneUniforms {
+    Uniform<glm::mat4> model;
+    Uniform<glm::mat3> normalMatrix;
+    Uniform<GLint> tex0;
+
+    SceneUniforms(const Shader& shader)
+    : model(shader, "model"), normalMatrix(shader, "normalMatrix"), tex0(shader, "tex0") {}
+};
+
+
+// Reparte el parseo de los .obj y la decodificación de imágenes entre los hilos de un ThreadPool.
+// Las llamadas a OpenGL (glBufferData, glTexImage2D) solo ocurren en Upload, en el hilo del contexto.
+// Cada malla se carga una sola vez por ruta y cada textura una sola vez por ruta y formato;
+// los modelos que las repiten comparten el mismo VAO/VBO/EBO o la misma textura.
+class AssetLoader {
+public:
+    AssetLoader(ThreadPool& pool) : pool(pool) {}
+
+    // Encola la carga de un modelo y devuelve su ticket; con keepVertices el Model conserva sus vértices en la CPU
+    size_t Request(const std::string& objFilePath, const std::string& texturePath, bool isPNG, bool keepVertices) {
+        PendingModel pending;
+        pending.objFilePath = objFilePath;
+        pending.isPNG = isPNG;
+
+        // Malla e imagen van en tareas separadas para que se decodifiquen en paralelo
+        auto mesh = meshSlots.find(objFilePath);
+        if (mesh == meshSlots.end()) {
+            mesh = meshSlots.emplace(objFilePath, meshJobs.size()).first;
+            meshJobs.push_back(pool.Enqueue([objFilePath]() {
+                MeshData mesh;
+                if (!loadMesh(objFilePath, mesh)) {
+                    std::cerr << "Error loading OBJ file: " << objFilePath << std::endl;
+                }
+                return mesh;
+            }));
+            meshKeepsVertices.push_back(false);
+        }
+        pending.meshSlot = mesh->second;
+        meshKeepsVertices[pending.meshSlot] = meshKeepsVertices[pending.meshSlot] || keepVertices;
+
+        // El formato forma parte de la clave: la misma imagen subida como RGB y como RGBA son texturas distintas
+        std::string textureKey = texturePath + (isPNG ? "#rgba" : "#rgb");
+        auto texture = textureSlots.find(textureKey);
+        if (texture == textureSlots.end()) {
+            texture = textureSlots.emplace(textureKey, textureJobs.size()).first;
+            textureJobs.push_back(pool.Enqueue([texturePath]() {
+                return decodeTexture(texturePath.c_str());
+            }));
+        }
+        pending.textureSlot = texture->second;
+
+        pendingModels.push_back(pending);
+        return pendingModels.size() - 1;
+    }
+
+    // Espera a los modelos encolados y los sube a la GPU; debe llamarse desde el hilo de OpenGL
+    void Upload(Shader& shaderProgram, GLuint unit) {
+        PROFILE_SCOPE("AssetLoader::Upload");
+        for (size_t ticket = loaded.size(); ticket < pendingModels.size(); ticket++) {
+            const PendingModel& pending = pendingModels[ticket];
+
+            // Los slots se numeran en orden de primera petición, así que uno nuevo siempre es el siguiente
+            if (pending.textureSlot == textures.size()) {
+                TextureImage image = textureJobs[pending.textureSlot].get();
+                GLenum format = pending.isPNG ? GL_RGBA : GL_RGB;
+                Texture Tex(image, GL_TEXTURE_2D, GL_TEXTURE0, format, GL_UNSIGNED_BYTE);
+                Tex.texUnit(shaderProgram, "tex0", unit);
+                textures.push_back(Tex);
+            }
+            const Texture& Tex = textures[pending.textureSlot];
+
+            if (pending.meshSlot == meshOwners.size()) {
+                // Una cache mapeada va directo a glBufferData y se cierra recién después de la subida
+                MeshData mesh = meshJobs[pending.meshSlot].get();
+                loaded.push_back(Model(mesh.VertexData(), mesh.VertexCount(), mesh.IndexData(), mesh.IndexCount(), pending.objFilePath, Tex));
+                if (meshKeepsVertices[pending.meshSlot]) {
+                    loaded.back().vertices.assign(mesh.VertexData(), mesh.VertexData() + mesh.VertexCount());
+                }
+                loaded.back().bounds = mesh.bounds;
+                mesh.Release();
+                meshOwners.push_back(ticket);
+            } else {
+                // Reutiliza los buffers del primer modelo que cargó esta malla
+                Model model = loaded[meshOwners[pending.meshSlot]];
+                model.texture = Tex;
+                loaded.push_back(model);
+            }
+        }
+    }
+
+    // Modelo ya subido correspondiente a un ticket
+    const Model& Get(size_t ticket) const {
+        return loaded[ticket];
+    }
+
+    // Cantidad de mallas y texturas distintas que realmente se cargaron
+    size_t MeshCount() const { return meshJobs.size(); }
+    size_t TextureCount() const { return textureJobs.size(); }
+
+private:
+    struct PendingModel {
+        std::string objFilePath;
+        bool isPNG;
+        size_t meshSlot;
+        size_t textureSlot;
+    };
+
+    ThreadPool& pool;
+    std::vector<PendingModel> pendingModels;
+    std::vector<Model> loaded;
+
+    std::unordered_map<std::string, size_t> meshSlots;
+    std::vector<std::future<MeshData>> meshJobs;
+    // Si algún modelo de la malla necesita sus vértices en la CPU
+    std::vector<bool> meshKeepsVertices;
+    // Ticket del modelo que subió cada malla
+    std::vector<size_t> meshOwners;
+
+    std::unordered_map<std::string, size_t> textureSlots;
+    std::vector<std::future<TextureImage>> textureJobs;
+    std::vector<Texture> textures;
 };
 
 
@@ -175,21 +603,46 @@ std::vector<glm::vec3> findTouchingRocks(const glm::vec3& newPos, const std::vec
     return touchingRocks;
 }
 
+// Lo mismo que isFarEnough, pero mirando solo las celdas de la grilla alrededor de newPos.
+bool isFarEnough(const glm::vec3& newPos, const SpatialGrid& grid, float minDist) {
+    return !grid.AnyWithin(newPos, minDist);
+}
+
+// Lo mismo que findTouchingRocks con la grilla; devuelve las mismas rocas (las primeras tres en orden de inserción).
+std::vector<glm::vec3> findTouchingRocks(const glm::vec3& newPos, const SpatialGrid& grid, float touchDist) {
+    std::vector<uint32_t> touching;
+    grid.ForEachWithin(newPos, touchDist, [&touching](uint32_t index, const glm::vec3&) {
+        touching.push_back(index);
+        return true;
+    });
+    std::sort(touching.begin(), touching.end());
+    if (touching.size() > 3) {
+        touching.resize(3);
+    }
+
+    std::vector<glm::vec3> touchingRocks;
+    for (uint32_t index : touching) {
+        touchingRocks.push_back(grid.Positions()[index]);
+    }
+    return touchingRocks;
+}
 
 
 
 
-void updateWaveModel(Model& model, float time) {
-    float amplitude = 100.0f; // Amplitud de las olas
-    float frequency = 0.5f; // Frecuencia de las olas
-    float speed = 10.0f;     // Velocidad de las olas
 
-    int index = 1; // Comenzamos desde el segundo elemento en el arreglo de vértices (índice 1)
-    for (int i = 0; i < model.vertices.size(); i += 3) {
+// La parte de updateWaveModel que corre en la CPU, sin la subida (bench.cpp la mide por separado)
+void displaceWaveVertices(std::vector<Vertex>& vertices, float time) {
+    for (int i = 0; i < vertices.size(); i++) {
         // Modificar la coordenada Y de cada vértice usando una función sinusoidal en función del tiempo
-            model.vertices[i].position[1] = amplitude * sin(frequency * (model.vertices[i].position[0] + model.vertices[i].position[2] + time * speed));
+            vertices[i].position[1] = waveAmplitude * sin(waveFrequency * (vertices[i].position[0] + vertices[i].position[2] + time * waveSpeed));
 
     }
+}
+
+void updateWaveModel(Model& model, float time) {
+    PROFILE_SCOPE("updateWaveModel");
+    displaceWaveVertices(model.vertices, time);
 
     // Actualizar el VBO con los nuevos vértices
     model.vbo.Bind();
@@ -203,131 +656,149 @@ void updateWaveModel(Model& model, float time) {
 
 
 
-Model loadModel(const std::string& objFilePath, const std::string& texturePath, bool isPNG, Shader& shaderProgram, GLuint i);
-void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height);
-}
-int main()
-{	
-	
-	// Inicializa GLFW
-    if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
-        return -1;
-    }
-
-    // Configura GLFW
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); // Mayor versión de OpenGL
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // Menor versión de OpenGL
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // Usar el perfil core de OpenGL
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // Necesario para MacOS
-#endif
+// Qué es cada asset de la escena, para decidir cómo se dibuja
+enum SceneGroup : uint32_t {
+    GROUP_FISH,
+    GROUP_ROCK,
+    GROUP_CORAL,
+    GROUP_PROP
+};
 
-    // Crea una ventana de GLFW
-    GLFWwindow* window = glfwCreateWindow(800, 600, "Multiple OBJ Loader", NULL, NULL);
-    if (window == NULL) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+// Versión de las reglas de generateScene: cambiarla invalida las instantáneas guardadas
+const uint32_t sceneLayoutVersion = 3;
+// Instantánea de la escena generada, que se mapea en el siguiente arranque en lugar de generar todo de nuevo
+const char* sceneSnapshotPath = "scene.snapshot";
+// Descripción de la escena: qué mallas hay, cuántas copias de cada una y cómo se colocan y dibujan
+const char* sceneManifestPath = "scene.manifest";
+
+// Grupo de dibujo que corresponde a cada regla de colocación del manifiesto
+SceneGroup sceneGroupFor(ManifestPlacement placement) {
+    switch (placement) {
+    case PLACE_FISH: return GROUP_FISH;
+    case PLACE_ROCKS: return GROUP_ROCK;
+    case PLACE_CORAL: return GROUP_CORAL;
+    default: return GROUP_PROP;
     }
+}
 
-    // Haz que el contexto de OpenGL sea el contexto actual
-    glfwMakeContextCurrent(window);
-
-    // Configura el callback para redimensionar la ventana
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-
-    // Inicializa GLAD
-    gladLoadGL(glfwGetProcAddress);
-
-
-    // Especifica el viewport de OpenGL en la ventana
-    glViewport(0, 0, 800, 600);
-
-
-	
-    // Generates Shader object using shaders default.vert and default.frag
-    Shader shaderProgram("default.vert", "default.frag");
-
-	//std::cout << "Probando donde esta el error "<< std::endl;
-
-
-    // Inicializa el generador de números aleatorios.
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> distPosXZ(-1300.0f, 1300.0f); // Rango para posiciones X y Z.
-    std::uniform_real_distribution<float> distPosY(-200.0f, 1000.0f); // Rango para posiciones Y de los peces.
-    std::uniform_real_distribution<float> distXZ(-1000.0f, 1000.0f); // Rango para posiciones X y Z de corales.
-    // Distribución para el ángulo theta y el radio.
-    std::uniform_real_distribution<float> distTheta(0.0f, 2 * M_PI);
-    std::uniform_real_distribution<float> distRadius(1000.0f, 1800.0f); // Radios más grandes para estar cerca de los bordes.
-    std::uniform_int_distribution<int> distRockIndex(0, 49); // Distribucion para seleccionar rocas de forma aleatoria
+// Separación del muestreo de Poisson para que entren `count` puntos en un dominio de tamaño `measure`
+// (área o volumen, según dims): Bridson llena unos 0.63 puntos por separación^dims, y se deja un margen
+// `headroom` para los candidatos que las reglas descartan. Nunca pasa de la separación de la escena original.
+float placementSpacing(float defaultSpacing, double measure, int dims, uint32_t count, double headroom) {
+    if (count == 0) {
+        return defaultSpacing;
+    }
+    double fit = std::pow(measure * 0.63 / (count * headroom), 1.0 / dims);
+    return std::min(defaultSpacing, (float)fit);
+}
 
+// Coloca los peces, rocas, corales y props que pide el manifiesto y arma la lista de assets que usan.
+void generateScene(const SceneManifest& manifest, ThreadPool& loaderPool, std::vector<SceneAssetDesc>& assets, std::vector<SnapshotEntity>& placed) {
+    PROFILE_SCOPE("generateScene");
+    const uint32_t fishCount = manifest.Count(PLACE_FISH);
+    const uint32_t rockCount = manifest.Count(PLACE_ROCKS);
+    const uint32_t coralCount = manifest.Count(PLACE_CORAL);
 
     std::vector<glm::vec3> fishPositions;
-    std::vector<glm::vec3> rockPositions = { glm::vec3(0.0f, -700.0f, 0.0f) };
+    std::vector<glm::vec3> rockPositions;
     std::vector<glm::vec3> coralPositions;
     std::unordered_set<int> usedRockIndices; // para no mas de 2 corales en la misma roca
 
+    // Con las cantidades del manifiesto original las separaciones son 400 y 100; con muchos más objetos
+    // (--fish, --rocks) se achican para que entren en el mismo volumen y el mismo anillo. Todas las
+    // distancias entre rocas (contacto, apilado, coral encima) se miden en separaciones de roca.
+    const PoissonDomain fishDomain = PoissonDomain::Box(glm::vec3(-1300.0f, -200.0f, -1300.0f), glm::vec3(1300.0f, 1000.0f, 1300.0f));
+    const PoissonDomain rockDomain = PoissonDomain::Annulus(1000.0f, 1800.0f, -700.0f);
+    // Candidatos por objeto pedido: los peces toman todos los que les tocan, las reglas de las rocas descartan muchos
+    const double fishHeadroom = 1.5, rockHeadroom = 4.0;
+    float fishSpacing = placementSpacing(400.0f, fishDomain.Measure(), 3, fishCount, fishHeadroom);
+    float rockSpacing = placementSpacing(100.0f, rockDomain.Measure(), 2, rockCount, rockHeadroom);
+
+    // Grilla para las búsquedas de vecinos, con celdas del tamaño de la distancia que se consulta
+    SpatialGrid rockGrid(2.0f * rockSpacing);
+
+    // La primera roca va en el centro del piso, las demás se apilan alrededor
+    if (rockCount > 0) {
+        rockPositions.push_back(glm::vec3(0.0f, -700.0f, 0.0f));
+        rockGrid.Insert(rockPositions[0]);
+    }
+
 
-    // Generar posiciones para los peces.
-    for (int i = 0; i < 14; ++i) {
-        glm::vec3 newPos;
-        do {
-            newPos = glm::vec3(distPosXZ(gen), distPosY(gen), distPosXZ(gen));
-        } while (!isFarEnough(newPos, fishPositions, 400.0f));
-        fishPositions.push_back(newPos);
+    // Los candidatos salen de un muestreo de Poisson (Bridson) en lugar de reintentar puntos al azar sin límite:
+    // ya vienen separados y en orden aleatorio, cada uno se prueba una sola vez y el tiempo queda acotado.
+    // El muestreo se corta en la cantidad pedida por el margen, así que cuesta según los objetos y no según
+    // cuántos entran en el dominio, y se reparte en franjas entre los hilos sin que cambie el resultado.
+
+    // Generar posiciones para los peces en el volumen del acuario.
+    if (fishCount > 0) {
+        std::vector<glm::vec3> fishSites = poissonDiskTiled(fishDomain, fishSpacing, sceneSeed, STREAM_FISH, loaderPool, 30,
+                                                           (size_t)std::ceil(fishCount * fishHeadroom));
+        for (const auto& site : fishSites) {
+            if (fishPositions.size() == fishCount) {
+                break;
+            }
+            fishPositions.push_back(site);
+        }
+        if (fishPositions.size() < fishCount) {
+            std::cerr << "Only " << fishPositions.size() << " fish fit in the volume" << std::endl;
+        }
     }
 
     // Generar posiciones para las rocas distribuidas cerca de los bordes de un área circular.
-    for (int i = 0; i < 99; ++i) {
-        glm::vec3 newPos;
-        do {
-            float theta = distTheta(gen); // Ángulo en radianes
-            float radius = distRadius(gen); // Distancia desde el centro
-            newPos = glm::vec3(radius * cos(theta), -700.0f, radius * sin(theta));
+    if (rockCount > 1) {
+        std::vector<glm::vec3> rockSites = poissonDiskTiled(rockDomain, rockSpacing, sceneSeed, STREAM_ROCKS, loaderPool, 30,
+                                                           (size_t)std::ceil(rockCount * rockHeadroom));
+        for (const auto& site : rockSites) {
+            if (rockPositions.size() == rockCount) {
+                break;
+            }
+            glm::vec3 newPos = site;
 
             // Verificar si la nueva roca está tocando dos o tres rocas existentes.
-            auto touchingRocks = findTouchingRocks(newPos, rockPositions, 200.0f);
+            auto touchingRocks = findTouchingRocks(newPos, rockGrid, 2.0f * rockSpacing);
             if (touchingRocks.size() == 2 || touchingRocks.size() == 3) {
-                //std::cout << "Encontro" << std::endl;
                 glm::vec3 centerPos(0.0f);
                 for (const auto& rock : touchingRocks) {
                     centerPos += rock;
                 }
                 centerPos /= static_cast<float>(touchingRocks.size());
-                newPos = centerPos + glm::vec3(0.0f, 100.0f, 0.0f); // Colocar la nueva roca encima.
+                newPos = centerPos + glm::vec3(0.0f, rockSpacing, 0.0f); // Colocar la nueva roca encima.
             }
 
-        } while (!isFarEnough(newPos, rockPositions, 100.0f)); // Asegurarse de que las rocas no se sobrepongan mucho.
-        rockPositions.push_back(newPos);
+            // Asegurarse de que las rocas no se sobrepongan mucho (una roca apilada puede caer sobre otra).
+            if (isFarEnough(newPos, rockGrid, rockSpacing)) {
+                rockGrid.Insert(newPos);
+                rockPositions.push_back(newPos);
+            }
+        }
+        if (rockPositions.size() < rockCount) {
+            std::cerr << "Only " << rockPositions.size() << " rocks fit in the annulus" << std::endl;
+        }
     }
 
 
-    // Generar posiciones para corales encima de las rocas.
-    for (int i = 0; i < 10; ++i) { // Asumiendo que hay 10 corales
+    // Generar posiciones para corales encima de las rocas, elegidas entre la primera mitad de las rocas.
+    uint32_t coralRockRange = std::max<uint32_t>(1, rockPositions.size() / 2);
+    for (uint32_t i = 0; i < coralCount && !rockPositions.empty(); ++i) {
         int rockIndex;
         bool validRockFound = false;
+        Philox coralRng(sceneSeed, streamId(STREAM_CORALS, i));
 
         // Intentar encontrar una roca válida que no tenga otra roca encima.
         for (int attempt = 0; attempt < 100; ++attempt) { // Limitar el número de intentos para evitar un bucle infinito.
-            rockIndex = distRockIndex(gen); // Seleccionar una roca aleatoria
+            rockIndex = randomIndex(coralRng, coralRockRange); // Seleccionar una roca aleatoria
             if (usedRockIndices.find(rockIndex) == usedRockIndices.end()) { // Asegurarse de no reutilizar la misma roca
                 // Verificar si esta roca tiene otra roca encima.
                 bool hasRockAbove = false;
                 glm::vec3 rockPos = rockPositions[rockIndex];
-                for (const auto& pos : rockPositions) {
-                    if (pos != rockPos && glm::distance(rockPos, pos) < 150.0f && pos.y > rockPos.y) {
-                        hasRockAbove = true;
-                        break;
-                    }
-                }
+                rockGrid.ForEachWithin(rockPos, 1.5f * rockSpacing, [&](uint32_t, const glm::vec3& pos) {
+                    hasRockAbove = pos != rockPos && pos.y > rockPos.y;
+                    return !hasRockAbove;
+                });
 
                 if (!hasRockAbove) {
                     usedRockIndices.insert(rockIndex); // Marcar esta roca como usada
-                    glm::vec3 coralPos = rockPos + glm::vec3(0.0f, 100.0f, 0.0f); // Ajustar la altura
+                    glm::vec3 coralPos = rockPos + glm::vec3(0.0f, rockSpacing, 0.0f); // Ajustar la altura
                     coralPositions.push_back(coralPos);
                     validRockFound = true;
                     break;
@@ -341,103 +812,365 @@ int main()
     }
 
 
+    // Cada línea del manifiesto es un asset; sus copias toman las siguientes posiciones de su regla,
+    // en el orden del archivo.
+    size_t nextFish = 0, nextRock = 0, nextCoral = 0;
+    for (const auto& entry : manifest.entries) {
+        uint32_t flags = 0;
+        if (entry.rgba) {
+            flags |= snapshotRGBA;
+        }
+        if (entry.blend == BLEND_ALPHA) {
+            flags |= snapshotTransparent;
+        }
+        if (entry.water) {
+            flags |= snapshotWater;
+        }
+        uint32_t asset = assets.size();
+        assets.push_back({ entry.mesh, entry.texture, sceneGroupFor(entry.placement), flags });
+
+        for (uint32_t copy = 0; copy < entry.count; copy++) {
+            glm::vec3 position;
+            if (entry.placement == PLACE_FISH && nextFish < fishPositions.size()) {
+                position = fishPositions[nextFish++];
+            } else if (entry.placement == PLACE_ROCKS && nextRock < rockPositions.size()) {
+                position = rockPositions[nextRock++];
+            } else if (entry.placement == PLACE_CORAL && nextCoral < coralPositions.size()) {
+                position = coralPositions[nextCoral++];
+            } else if (entry.placement == PLACE_FIXED) {
+                position = entry.position;
+            } else {
+                break; // No quedaron posiciones para esta regla (ya se avisó arriba)
+            }
+            placed.push_back(snapshotEntity(position, entry.rotation, sceneScale, entry.motion, asset));
+        }
+    }
+}
+
+
+
+
+// Opciones de la línea de comandos
+struct RunOptions {
+    // Sin ventana: contexto EGL/OSMesa y dibujo en un FBO
+    bool headless = false;
+    unsigned int width = ::width;
+    unsigned int height = ::height;
+    // Frames a dibujar sin ventana o en benchmark (0: 300 sin ventana, el recorrido completo en benchmark)
+    unsigned int frames = 0;
+    // Archivo .ppm donde se guarda el último frame sin ventana (vacío: no se guarda)
+    std::string outputPath;
+    // Recorrido de cámara del modo benchmark (vacío: cámara con teclado)
+    std::string cameraPathFile;
+    // Archivo .json o .csv con los tiempos del benchmark
+    std::string reportPath;
+    // Archivo .json donde se guarda la traza del profiler al salir (vacío: el profiler queda apagado)
+    std::string profilePath;
+    // Cantidades de peces, rocas y corales en lugar de las del manifiesto (-1: las del manifiesto)
+    long long fish = -1;
+    long long rocks = -1;
+    long long corals = -1;
+};
 
-    // Generar posiciones para piso y agua (si son necesarias).
-    glm::vec3 floorPosition = glm::vec3(0.0f, -800.0f, 0.0f);
-    glm::vec3 superPosition = glm::vec3(-2000.0f, 1250.0f, -1800.0f);
-    glm::vec3 waterPosition = glm::vec3(0.0f, 300.0f, 0.0f);
-    glm::vec3 tablePosition = glm::vec3(0.0f, -2400.0f, 0.0f);
-    glm::vec3 pared1Position = glm::vec3(-10000.0f, -4000.0f, -8000.0f);
-    glm::vec3 pared2Position = glm::vec3(-10000.0f, -4000.0f, 8000.0f);
-    glm::vec3 pared3Position = glm::vec3(10000.0f, -4000.0f, -10000.0f);
-    glm::vec3 pared4Position = glm::vec3(-10000.0f, -4000.0f, -10000.0f);
-    glm::vec3 pisoPosition = glm::vec3(-10000.0f, -3800.0f, -10000.0f);
-    glm::vec3 techoPosition = glm::vec3(-10000.0f, 6000.0f, -10000.0f);
+// Lee una cantidad de --fish, --rocks o --corals: un entero en [0, UINT32_MAX], sin nada detrás
+bool parseCount(const char* text, long long& count) {
+    char* end;
+    long long value = strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || value < 0 || value > (long long)UINT32_MAX) {
+        return false;
+    }
+    count = value;
+    return true;
+}
 
+// Lee las opciones: --headless, --size WxH, --frames N, --output archivo.ppm, --camera-path archivo, --report archivo,
+// --fish N, --rocks N, --corals N, --profile traza.json
+bool parseOptions(int argc, char* argv[], RunOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--headless") == 0) {
+            options.headless = true;
+        } else if (strcmp(argv[i], "--size") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%ux%u", &options.width, &options.height) != 2 || options.width == 0 || options.height == 0) {
+                std::cerr << "Invalid size: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            options.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+            options.outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--camera-path") == 0 && hasValue) {
+            options.cameraPathFile = argv[++i];
+        } else if (strcmp(argv[i], "--report") == 0 && hasValue) {
+            options.reportPath = argv[++i];
+        } else if (strcmp(argv[i], "--fish") == 0 && hasValue) {
+            if (!parseCount(argv[++i], options.fish)) {
+                std::cerr << "Invalid fish count: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (strcmp(argv[i], "--rocks") == 0 && hasValue) {
+            if (!parseCount(argv[++i], options.rocks)) {
+                std::cerr << "Invalid rock count: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (strcmp(argv[i], "--corals") == 0 && hasValue) {
+            if (!parseCount(argv[++i], options.corals)) {
+                std::cerr << "Invalid coral count: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (strcmp(argv[i], "--profile") == 0 && hasValue) {
+            options.profilePath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--headless] [--size WxH] [--frames N] [--output frame.ppm]"
+                      << " [--camera-path path.txt] [--report report.json|report.csv] [--fish N] [--rocks N] [--corals N]"
+                      << " [--profile trace.json]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
 
+// Guarda píxeles RGBA (la fila de abajo primero, como los devuelve glReadPixels) en un .ppm binario
+bool writePPM(const std::string& path, const std::vector<unsigned char>& pixels, unsigned int width, unsigned int height) {
+    std::ofstream out(path, std::ios::binary);
+    out << "P6\n" << width << " " << height << "\n255\n";
+    for (unsigned int y = height; y-- > 0;) {
+        for (unsigned int x = 0; x < width; x++) {
+            out.write((const char*)&pixels[((size_t)y * width + x) * 4], 3);
+        }
+    }
+    return (bool)out;
+}
 
+// bench.cpp incluye este archivo para medir las funciones de arriba; su propio main reemplaza a este
+#ifndef AQUARIUM_NO_MAIN
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    glViewport(0, 0, width, height);
+}
+int main(int argc, char* argv[])
+{	
+    RunOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return -1;
+    }
+    // Con --profile se registran los scopes de todos los hilos y al salir se escribe la traza
+    if (!options.profilePath.empty()) {
+        Profiler::Enable(true);
+    }
+    Profiler::SetThreadName("main");
+
+    // Sin ventana no se inicializa GLFW (en una máquina sin display fallaría): el contexto sale de EGL
+    // u OSMesa y todo se dibuja en un FBO del tamaño pedido.
+    GLFWwindow* window = NULL;
+    HeadlessContext headlessContext;
+    std::unique_ptr<FBO> offscreen;
+    if (options.headless) {
+        if (!headlessContext.Create()) {
+            return -1;
+        }
+        gladLoadGL(HeadlessContext::GetProcAddress);
+
+        offscreen.reset(new FBO(options.width, options.height));
+        if (!offscreen->Complete()) {
+            std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+            offscreen->Delete();
+            headlessContext.Destroy();
+            return -1;
+        }
+        offscreen->Bind();
+        glViewport(0, 0, options.width, options.height);
+    } else {
+        // Inicializa GLFW
+        if (!glfwInit()) {
+            std::cerr << "Failed to initialize GLFW" << std::endl;
+            return -1;
+        }
 
-    // Combinar todas las posiciones en un solo vector.
-    std::vector<glm::vec3> allPositions = fishPositions;
-    allPositions.insert(allPositions.end(), rockPositions.begin(), rockPositions.end());
-    allPositions.insert(allPositions.end(), coralPositions.begin(), coralPositions.end());
-    allPositions.push_back(floorPosition);
-    allPositions.push_back(tablePosition);
-    allPositions.push_back(pared1Position);
-    allPositions.push_back(pared2Position);
-    allPositions.push_back(pared3Position);
-    allPositions.push_back(pared4Position);
-    allPositions.push_back(pisoPosition);
-    allPositions.push_back(techoPosition);
+        // Configura GLFW
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); // Mayor versión de OpenGL
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // Menor versión de OpenGL
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // Usar el perfil core de OpenGL
 
-    allPositions.push_back(superPosition);
-    allPositions.push_back(waterPosition);
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // Necesario para MacOS
+#endif
 
+        // Crea una ventana de GLFW
+        window = glfwCreateWindow(options.width, options.height, "Multiple OBJ Loader", NULL, NULL);
+        if (window == NULL) {
+            std::cerr << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
 
+        // Haz que el contexto de OpenGL sea el contexto actual
+        glfwMakeContextCurrent(window);
 
+        // Configura el callback para redimensionar la ventana
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-    std::vector<Model> models;
-    models.push_back(loadModel("Models/TropicalFish01.obj", "Models/TropicalFish01.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish02.obj", "Models/TropicalFish02.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish03.obj", "Models/TropicalFish03.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish04.obj", "Models/TropicalFish04.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish05.obj", "Models/TropicalFish05.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish06.obj", "Models/TropicalFish06.jpg", false ,shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish07.obj", "Models/TropicalFish07.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish08.obj", "Models/TropicalFish08.jpg", false,  shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish09.obj", "Models/TropicalFish09.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish10.obj", "Models/TropicalFish10.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish11.obj", "Models/TropicalFish11.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish12.obj", "Models/TropicalFish12.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish13.obj", "Models/TropicalFish13.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/TropicalFish14.obj", "Models/TropicalFish14.jpg", false, shaderProgram, 0));
+        // Inicializa GLAD
+        gladLoadGL(glfwGetProcAddress);
 
 
-    Model rocas = loadModel("Models/Roca-Test.obj", "Models/Rock-Texture-Surface.jpg", false,  shaderProgram, 0);
-    int conta = 0;
-    for (int i = 0; i < 100; i++) {
-        //rocas.position =  allPositions[14+i+1];
-        models.push_back(rocas);
-        conta = 14 + i + 1;
+        // Especifica el viewport de OpenGL en la ventana
+        glViewport(0, 0, options.width, options.height);
     }
 
+    // Cierra lo que se abrió arriba: el FBO y el contexto EGL/OSMesa sin ventana, la ventana y GLFW con ella.
+    // Todas las salidas de acá en adelante pasan por aquí.
+    auto shutdown = [&]() {
+        if (!window) {
+            offscreen->Delete();
+            headlessContext.Destroy();
+        } else {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        }
+    };
+
+
+	
+    // Generates Shader object using shaders default.vert and default.frag
+    Shader shaderProgram("default.vert", "default.frag");
+
+	//std::cout << "Probando donde esta el error "<< std::endl;
 
-   Model coral1 = loadModel("Models/coral_v1.obj", "Models/coral01.jpg", false, shaderProgram, 0);
 
-    Model coral2 = loadModel("Models/coral2.obj", "Models/coral2.jpg", false, shaderProgram, 0);
-    for (int i = 0; i < 5; i++) {
-        //coral1.position = allPositions[117 + i];
-        models.push_back(coral1);
+    // Hilos para la generación de la escena y después para la carga de modelos y texturas.
+    ThreadPool loaderPool;
+
+
+    // La escena sale del manifiesto; sin él no hay nada que dibujar.
+    SceneManifest manifest;
+    if (!manifest.Load(sceneManifestPath)) {
+        shutdown();
+        return -1;
+    }
+    // Escenas más grandes o más chicas que la del manifiesto, para medir cómo escala
+    if (options.fish >= 0) {
+        manifest.SetCount(PLACE_FISH, options.fish);
+    }
+    if (options.rocks >= 0) {
+        manifest.SetCount(PLACE_ROCKS, options.rocks);
+    }
+    if (options.corals >= 0) {
+        manifest.SetCount(PLACE_CORAL, options.corals);
     }
 
-    for (int i = 0; i < 5; i++) {
-        //coral1.position = allPositions[122 + i];
-        models.push_back(coral2);
+    // La escena generada se guarda en una instantánea; si hay una de la misma semilla y del mismo
+    // manifiesto se mapea y se salta toda la colocación.
+    SceneSnapshot scene;
+    if (scene.Open(sceneSnapshotPath, sceneSeed, manifest.hash, sceneLayoutVersion)) {
+        std::cout << "Mapped scene snapshot with " << scene.EntityCount() << " entities" << std::endl;
+    } else {
+        std::vector<SceneAssetDesc> assets;
+        std::vector<SnapshotEntity> placed;
+        generateScene(manifest, loaderPool, assets, placed);
+        scene.Build(sceneSeed, manifest.hash, sceneLayoutVersion, assets, placed);
+        if (!scene.Write(sceneSnapshotPath)) {
+            std::cerr << "Could not write scene snapshot: " << sceneSnapshotPath << std::endl;
+        }
     }
 
 
 
-   // models.push_back(loadModel("Models/82_vray_and_corona_2014.obj", "Models/arena.jpg", shaderProgram, 0));
+    // El parseo de los .obj y la decodificación de las texturas se reparten entre todos los núcleos;
+    // cada Request devuelve un ticket y Upload sube los datos listos a la GPU desde este hilo.
+    AssetLoader loader(loaderPool);
+
+
+    // Entidades de la instantánea agrupadas por asset
+    std::vector<std::vector<uint32_t>> assetEntities(scene.AssetCount());
+    for (uint32_t e = 0; e < scene.EntityCount(); e++) {
+        assetEntities[scene.entities[e].asset].push_back(e);
+    }
 
-    models.push_back(loadModel("Models/base.obj", "Models/arena.jpg",false, shaderProgram, 0));
+    // Todos los assets del manifiesto se piden de una vez, antes de esperar a ninguno; las mallas y texturas
+    // repetidas se cargan una sola vez y los assets sin copias colocadas no se cargan.
+    std::vector<size_t> tickets(scene.AssetCount());
+    for (uint32_t a = 0; a < scene.AssetCount(); a++) {
+        if (!assetEntities[a].empty()) {
+            // Solo el agua animada en la CPU necesita sus vértices después de subirlos
+            bool keepVertices = !gpuWaves && (scene.assets[a].flags & snapshotWater) != 0;
+            tickets[a] = loader.Request(scene.Mesh(a), scene.Texture(a), (scene.assets[a].flags & snapshotRGBA) != 0, keepVertices);
+        }
+    }
 
-    models.push_back(loadModel("Models/table2.obj", "Models/WoodSeemles1.jpg", false, shaderProgram, 0));
+    loader.Upload(shaderProgram, 0);
+    std::cout << "Loaded " << loader.MeshCount() << " meshes and " << loader.TextureCount() << " textures" << std::endl;
 
-    models.push_back(loadModel("Models/vertical_square.obj", "Models/pared.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/vertical_square.obj", "Models/pared.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/vertical_square2.obj", "Models/pared.jpg", false, shaderProgram, 0));
-    models.push_back(loadModel("Models/vertical_square2.obj", "Models/pared.jpg", false, shaderProgram, 0));
 
+    // Cada objeto de la escena es una entidad del EntityStore que apunta al Model con que se dibuja;
+    // las mallas repetidas (rocas, corales) están una sola vez en models.
+    std::vector<Model> models;
+    std::vector<InstancedModel> instancedModels;
+    EntityStore entities;
+    for (uint32_t a = 0; a < scene.AssetCount(); a++) {
+        if (assetEntities[a].empty()) {
+            continue;
+        }
+        Model model = loader.Get(tickets[a]);
+        uint32_t group = scene.assets[a].group;
+        // Estado de dibujo que depende de la malla, decidido por el manifiesto y no en cada frame
+        bool transparent = (scene.assets[a].flags & snapshotTransparent) != 0;
+
+        if (group == GROUP_FISH && gpuFish) {
+            // Un lote por especie; todos sus peces se animan en fish.vert con el mismo reloj, cada uno con su fase
+            std::vector<FishInstance> school;
+            for (uint32_t e : assetEntities[a]) {
+                const SnapshotEntity& fish = scene.entities[e];
+                glm::vec3 position(fish.position[0], fish.position[1], fish.position[2]);
+                school.push_back(makeFishInstance(position, (SwimBehavior)fish.behavior, fishPhase(e)));
+            }
+            instancedModels.push_back(InstancedModel(model, school));
+            instancedModels.back().transparent = transparent;
+        } else if ((group == GROUP_ROCK || group == GROUP_CORAL) && instancedRendering) {
+            // Las mismas matrices que tendría cada entidad, calculadas una sola vez.
+            std::vector<glm::mat4> transforms;
+            for (uint32_t e : assetEntities[a]) {
+                const SnapshotEntity& placed = scene.entities[e];
+                transforms.push_back(composeWorld(glm::vec3(placed.position[0], placed.position[1], placed.position[2]),
+                    glm::vec3(placed.rotation[0], placed.rotation[1], placed.rotation[2]), placed.scale));
+            }
+            instancedModels.push_back(InstancedModel(model, transforms));
+            instancedModels.back().transparent = transparent;
+        } else {
+            model.transparent = transparent;
+            model.isWater = (scene.assets[a].flags & snapshotWater) != 0;
+            uint32_t modelIndex = models.size();
+            models.push_back(model);
+            for (uint32_t e : assetEntities[a]) {
+                const SnapshotEntity& placed = scene.entities[e];
+                entities.Add(glm::vec3(placed.position[0], placed.position[1], placed.position[2]),
+                    glm::vec3(placed.rotation[0], placed.rotation[1], placed.rotation[2]), placed.scale, (SwimBehavior)placed.behavior, modelIndex,
+                    group == GROUP_FISH ? fishPhase(e) : 0.0f);
+            }
+        }
+    }
 
-    models.push_back(loadModel("Models/piso.obj", "Models/piso.jpg", false ,shaderProgram, 0));
-    models.push_back(loadModel("Models/piso.obj", "Models/techo.jpeg", false, shaderProgram, 0));
+    // Simulación del agua en la CPU con el stream de alturas en la ubicación 4 del VAO del agua
+    std::unique_ptr<WaveEngine> waveEngine;
+    if (!gpuWaves && simdWaves) {
+        for (auto& model : models) {
+            if (model.isWater) {
+                waveEngine.reset(new WaveEngine(model.vertices, model.vao, 4, WaveParams{ waveAmplitude, waveFrequency, waveSpeed }));
+            }
+        }
+    }
 
-    models.push_back(loadModel("Models/superficie2.obj", "Models/celeste.png", true,shaderProgram, 0));
 
 
-    models.push_back(loadModel("Models/finalcube.obj", "Models/azul.png", true, shaderProgram, 0));
+    // Shader for the instanced rocks and corals (same fragment shader as the rest of the models)
+    Shader instancedProgram("instanced.vert", "default.frag");
 
+    // Shader for the fish schools, animated on the GPU
+    Shader fishProgram("fish.vert", "default.frag");
 
+    // Shader for the water surface, displaced on the GPU
+    Shader waterProgram("water.vert", "default.frag");
+    // Shader for the water surface when its heights come from WaveEngine
+    Shader waterHeightsProgram("waterHeights.vert", "default.frag");
 
     // Shader for light cube
     Shader lightShader("light.vert", "light.frag");
@@ -467,13 +1200,38 @@ int main()
     pyramidModel = glm::translate(pyramidModel, pyramidPos);
 
 
+    // Handles con las ubicaciones ya cacheadas de cada programa
+    SceneUniforms lightUniforms(lightShader);
+    SceneUniforms instancedUniforms(instancedProgram);
+    SceneUniforms modelUniforms(shaderProgram);
+    SceneUniforms waterUniforms(waterProgram);
+    SceneUniforms waterHeightsUniforms(waterHeightsProgram);
+    Uniform<GLfloat> waterTime(waterProgram, "time");
+    SceneUniforms fishUniforms(fishProgram);
+    Uniform<GLfloat> fishTime(fishProgram, "time");
+
     lightShader.Activate();
-    glUniformMatrix4fv(glGetUniformLocation(lightShader.ID, "model"), 1, GL_FALSE, glm::value_ptr(lightModel));
-    glUniform4f(glGetUniformLocation(lightShader.ID, "lightColor"), lightColor.x, lightColor.y, lightColor.z, lightColor.w);
+    lightUniforms.model.Set(lightModel);
+    instancedProgram.Activate();
+    instancedUniforms.tex0.Set(0);
+    fishProgram.Activate();
+    fishUniforms.tex0.Set(0);
+    Uniform<GLfloat>(fishProgram, "sceneScale").Set(sceneScale);
+    waterHeightsProgram.Activate();
+    waterHeightsUniforms.tex0.Set(0);
+    waterProgram.Activate();
+    waterUniforms.tex0.Set(0);
+    Uniform<GLfloat>(waterProgram, "waveAmplitude").Set(waveAmplitude);
+    Uniform<GLfloat>(waterProgram, "waveFrequency").Set(waveFrequency);
+    Uniform<GLfloat>(waterProgram, "waveSpeed").Set(waveSpeed);
     shaderProgram.Activate();
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram.ID, "model"), 1, GL_FALSE, glm::value_ptr(pyramidModel));
-    glUniform4f(glGetUniformLocation(shaderProgram.ID, "lightColor"), lightColor.x, lightColor.y, lightColor.z, lightColor.w);
-    glUniform3f(glGetUniformLocation(shaderProgram.ID, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
+    modelUniforms.model.Set(pyramidModel);
+
+    // Datos de cámara y luz compartidos por todos los programas, se escriben una vez por frame
+    FrameBlock frame;
+    frame.lightColor = lightColor;
+    frame.lightPos = glm::vec4(lightPos, 1.0f);
+    UBO frameUBO(sizeof(FrameBlock), frameBlockBinding);
 
 
 
@@ -487,236 +1245,188 @@ int main()
 
 
     // Creates camera object
-    Camera camera(width, height, glm::vec3(0.0f, 40.0f, 70.0f));
+    Camera camera(options.width, options.height, glm::vec3(0.0f, 40.0f, 70.0f));
+
+    // Cola de dibujo; su plano lejano coincide con el de la cámara para cuantizar la profundidad
+    RenderQueue renderQueue;
+    renderQueue.farPlane = 1000.0f;
+
+
+    // Modo benchmark: la cámara sigue un recorrido con un reloj fijo durante la cantidad de frames pedida,
+    // y se miden los tiempos de CPU y GPU de cada frame
+    bool benchmark = !options.cameraPathFile.empty();
+    CameraPath cameraPath;
+    std::unique_ptr<GpuTimer> gpuTimer;
+    FrameStats frameStats;
+    if (benchmark) {
+        if (!cameraPath.Load(options.cameraPathFile)) {
+            shutdown();
+            return -1;
+        }
+        // Sin --frames se mide el recorrido entero, del primer keyframe al último, con el reloj fijo
+        if (options.frames == 0) {
+            options.frames = (unsigned int)std::lround(cameraPath.Duration() / benchmarkFrameStep) + 1;
+        }
+        gpuTimer.reset(new GpuTimer());
+        // Sin vsync, para que el swap no iguale todos los frames al refresco de la pantalla
+        if (window) {
+            glfwSwapInterval(0);
+        }
+    } else if (options.frames == 0) {
+        options.frames = 300;
+    }
 
+    // Reloj de la escena en segundos: el de GLFW con ventana; sin ventana GLFW no está inicializado y se usa uno propio
+    auto startTime = std::chrono::steady_clock::now();
+    unsigned int frameCount = 0;
+    unsigned int warmupFrames = benchmark ? benchmarkWarmupFrames : 0;
+    auto sceneTime = [&]() -> double {
+        if (benchmark) {
+            return frameCount < warmupFrames ? 0.0 : (frameCount - warmupFrames) * benchmarkFrameStep;
+        }
+        if (window) {
+            return glfwGetTime();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    };
 
-    // Main while loop
-    while (!glfwWindowShouldClose(window))
+    // Main while loop (sin ventana o en benchmark, hasta dibujar los frames pedidos)
+    bool fixedFrameCount = !window || benchmark;
+    while ((!window || !glfwWindowShouldClose(window)) && (!fixedFrameCount || frameCount < warmupFrames + options.frames))
     {
+        PROFILE_SCOPE("frame");
+        auto frameStart = std::chrono::steady_clock::now();
+        // Un solo instante para todo el frame
+        double frameTime = sceneTime();
+        bool measured = benchmark && frameCount >= warmupFrames;
+        if (measured) {
+            gpuTimer->Begin();
+        }
+
         // Specify the color of the background
         glClearColor(0.07f, 0.13f, 0.17f, 1.0f);
         // Clean the back buffer and depth buffer
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 
         // Handles camera inputs
-        camera.Inputs(window);
-        // Updates and exports the camera matrix to the Vertex Shader
-        camera.updateMatrix(45.0f, 0.2f, 1000.0f);
-
-
-
-        // Tells OpenGL which Shader Program we want to use
-        lightShader.Activate();
-        // Export the camMatrix to the Vertex Shader of the light cube
-        camera.Matrix(lightShader, "camMatrix");
-        // Bind the VAO so OpenGL knows to use it
-        lightVAO.Bind();
-        // Draw primitives, number of indices, datatype of indices, index of indices
-        glDrawElements(GL_TRIANGLES, sizeof(lightIndices) / sizeof(int), GL_UNSIGNED_INT, 0);
-
-        // Tells OpenGL which Shader Program we want to use
-        shaderProgram.Activate();
-        // Exports the camera Position to the Fragment Shader for specular lighting
-        glUniform3f(glGetUniformLocation(shaderProgram.ID, "camPos"), camera.Position.x, camera.Position.y, camera.Position.z);
-        // Export the camMatrix to the Vertex Shader of the pyramid
-        camera.Matrix(shaderProgram, "camMatrix");
-        // Binds texture so that is appears in rendering
-
-
-
-        // Variables para la rotación
-        float angleV2 = glfwGetTime(); // Usa el tiempo actual para animar la rotación
-        glm::mat4 rotationMat = glm::rotate(glm::mat4(1.0f), angleV2, glm::vec3(0.0f, 1.0f, 0.0f));
-        // Ajusta la distancia máxima permitida para el movimiento circular/elíptico
-        float maxDistance = 1000.0f;
-        float maxDistanceSquared = maxDistance * maxDistance;
-		
-		
-
-        int i = 1;
-        for (auto& model:models){
-            glm::mat4 modelMat = glm::mat4(1.0f);
-
-            modelMat = glm::scale(modelMat, glm::vec3(0.01f)); // Escalar el modelo al 10% de su tamaño original
-            modelMat = glm::translate(modelMat, allPositions[i]);
-
-            if (model.ModelName != "Models/finalcube.obj" || model.ModelName != "Models/superficie2.obj") {
-                glDisable(GL_BLEND);
-            }
-
-            if (model.ModelName == "Models/coral_v1.obj") { // El segundo coral es el 18º modelo, índice 17
-                modelMat = glm::rotate(modelMat, glm::radians(270.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        {
+            PROFILE_SCOPE("camera.Inputs");
+            if (benchmark) {
+                cameraPath.Apply(camera, frameTime);
+            } else if (window) {
+                camera.Inputs(window);
             }
+        }
+        // Updates and exports the camera matrix to the Vertex Shader
+        {
+            PROFILE_SCOPE("camera.updateMatrix");
+            camera.updateMatrix(45.0f, 0.2f, 1000.0f);
+        }
 
+        // Una sola subida de cámara y luz para todos los programas
+        {
+            PROFILE_SCOPE("frameUBO upload");
+            frame.camMatrix = camera.cameraMatrix;
+            frame.camPos = glm::vec4(camera.Position, 1.0f);
+            frameUBO.Update(&frame, sizeof(FrameBlock));
+        }
 
-            if (model.ModelName == "Models/cube.obj") { // El segundo coral es el 18º modelo, índice 17
-                std::cout << i << std::endl;
-            }
-
-
-
-            if (i < 7) {
-                float angleTest = atan2(allPositions[i][0], allPositions[i][2]) * 180 /M_PI;
-                modelMat = glm::rotate(modelMat, glm::radians(angleTest), glm::vec3(0.0f, 1.0f, 0.0f));
-                // Calcula la distancia al centro
-
-                float distanceToCenter = sqrt(allPositions[i][0] * allPositions[i][0] + allPositions[i][2] * allPositions[i][2]);
-                float rotationSpeed = 1000 / distanceToCenter;
-
-
-                if (allPositions[i][0] > 0.0f) {
-                    modelMat = glm::rotate(modelMat, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                    rotationMat = glm::rotate(glm::mat4(1.0f), angleV2 * rotationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
-                    modelMat = rotationMat * modelMat;
-                } else {
-                    modelMat = glm::rotate(modelMat, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                    rotationMat = glm::rotate(glm::mat4(1.0f), -angleV2 * rotationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
-                    modelMat = rotationMat * modelMat;
-                }
-
-                // Supongamos que la posición de la cabeza está en headOffset respecto al centro del modelo
-                glm::vec3 headOffset = glm::vec3(0.0f, 0.0f, -300.0f); // ejemplo: 1.8 unidades arriba del centro del cuerpo
-
-                // Desplazar el modelo de manera que la cabeza esté en el origen
-                modelMat = glm::translate(modelMat, -headOffset);
-
-                // Aplicar la rotación alrededor del eje Y desde la posición de la cabeza
-                float zOffset = 100.0f * sin(glfwGetTime() * 20.0f);
-                float tiltAngleZ = glm::radians(zOffset / 200.0f * 15.0f); // 15 grados es el ángulo máximo de giro en Z
-                modelMat = glm::rotate(modelMat, tiltAngleZ, glm::vec3(0.0f, 1.0f, 0.0f));
 
-                // Desplazar el modelo de regreso a su posición original
-                modelMat = glm::translate(modelMat, headOffset);
 
+        // Todos los dibujos del frame pasan por la cola, que los ordena para cambiar de estado lo menos posible
+        renderQueue.Clear();
 
+        // Cubo de la luz
+        DrawCommand lightDraw;
+        lightDraw.shader = lightShader.ID;
+        lightDraw.vao = lightVAO.ID;
+        lightDraw.indexCount = sizeof(lightIndices) / sizeof(int);
+        renderQueue.Submit(lightDraw, false, glm::distance(camera.Position, lightPos));
 
+        // Rocas, corales y bancos de peces: una llamada por malla para todas sus instancias
+        for (auto& instanced : instancedModels) {
+            if (!camera.frustum.Intersects(instanced.worldBounds, glm::mat4(1.0f))) {
+                continue;
             }
-
-
-
-            // Aplicar rotación alrededor del origen (0,0,0) para los peces
-            if (i > 6 && i < 10) {
-                // Cálculo del ángulo y la velocidad de rotación
-                float angleTest = atan2(allPositions[i][0], allPositions[i][2]) * 180 /M_PI;
-                modelMat = glm::rotate(modelMat, glm::radians(angleTest), glm::vec3(0.0f, 1.0f, 0.0f));
-                float distanceToCenter = sqrt(allPositions[i][0] * allPositions[i][0] + allPositions[i][2] * allPositions[i][2]);
-                float rotationSpeed = 1000 / distanceToCenter;
-
-                // Aplicar la rotación horizontal
-                if (allPositions[i][0] > 0.0f) {
-                    modelMat = glm::rotate(modelMat, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                    rotationMat = glm::rotate(glm::mat4(1.0f), angleV2 * rotationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
-                    modelMat = rotationMat * modelMat;
-                } else {
-                    modelMat = glm::rotate(modelMat, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                    rotationMat = glm::rotate(glm::mat4(1.0f), -angleV2 * rotationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
-                    modelMat = rotationMat * modelMat;
-                }
-
-                // Aplicar movimiento sinusoidal para la coordenada Y
-                float yOffset = 250.0f * sin(glfwGetTime() * 5.0f); // 5.0f es la frecuencia de oscilación
-                float zOffset = 100.0f * sin(glfwGetTime() * 20.0f);
-
-
-                // Añadir rotación en el eje X para inclinar el pez hacia arriba o abajo
-                float tiltAngleX = glm::radians(yOffset / 200.0f * 20.0f); // 45 grados es el ángulo máximo de inclinación
-
-                // Añadir rotación en el eje Z para girar el pez hacia arriba o abajo
-                float tiltAngleZ = glm::radians(zOffset / 200.0f * 15.0f); // 15 grados es el ángulo máximo de giro en Z
-
-                // Aplicar las rotaciones centradas
-                modelMat = glm::translate(modelMat, glm::vec3(0.0f, yOffset, 0.0f));
-                modelMat = glm::rotate(modelMat, tiltAngleX, glm::vec3(1.0f, 0.0f, 0.0f));
-                modelMat = glm::rotate(modelMat, tiltAngleZ, glm::vec3(0.0f, 1.0f, 0.0f));
-
+            // El anillo de rocas rodea a la cámara y su caja casi siempre se ve: se descarta cada instancia
+            instanced.Cull(camera.frustum);
+            if (instanced.visibleCount == 0) {
+                continue;
             }
+            DrawCommand draw;
+            draw.shader = instanced.swimming ? fishProgram.ID : instancedProgram.ID;
+            draw.texture = instanced.model.texture.ID;
+            draw.vao = instanced.model.vao.ID;
+            draw.indexCount = instanced.model.indexCount;
+            draw.instanceCount = instanced.visibleCount;
+            renderQueue.Submit(draw, instanced.transparent, glm::distance(camera.Position, instanced.worldBounds.center));
+        }
 
 
+        // Matrices de las entidades que se mueven; las de las quietas se calcularon al crearlas
+        // y solo se rehacen si alguien las marca con MarkDirty
+        float angleV2 = frameTime; // Usa el tiempo actual para animar la rotación
+        entities.Update(angleV2, loaderPool);
 
+        for (size_t e = 0; e < entities.Size(); e++) {
+            Model& model = models[entities.renderables[e]];
+            const glm::mat4& modelMat = entities.worldMatrices[e];
 
+            float currentTime = frameTime;
+            if (model.isWater && !gpuWaves && waveEngine) {
+                waveEngine->Update(currentTime, loaderPool);
+                waveEngine->Upload();
+            } else if (model.isWater && !gpuWaves) {
 
-            if (i > 9 && i < 14) {
-                // Cálculo del ángulo y la velocidad de rotación
-                float angleTest = atan2(allPositions[i][0], allPositions[i][2]) * 180 /M_PI;
-                modelMat = glm::rotate(modelMat, glm::radians(angleTest), glm::vec3(0.0f, 1.0f, 0.0f));
-                float distanceToCenter = sqrt(allPositions[i][0] * allPositions[i][0] + allPositions[i][2] * allPositions[i][2]);
-                float rotationSpeed = 1000 / distanceToCenter;
-
-                // Aplicar la rotación horizontal
-                if (allPositions[i][0] > 0.0f) {
-                    modelMat = glm::rotate(modelMat, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                    rotationMat = glm::rotate(glm::mat4(1.0f), angleV2 * rotationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
-                    modelMat = rotationMat * modelMat;
-                } else {
-                    modelMat = glm::rotate(modelMat, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                    rotationMat = glm::rotate(glm::mat4(1.0f), -angleV2 * rotationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
-                    modelMat = rotationMat * modelMat;
-                }
-
-                // Calcular la posición en forma de ocho
-                float x = 500.0f * sin(2.0f * glfwGetTime()); // 2.0f es la frecuencia en x
-                float y = 0.0f;
-                float z = 250.0f * cos(4.0f * glfwGetTime()); // 4.0f es la frecuencia en y
-
-                glm::vec3 newPosition = glm::vec3(x, y, z);
-                modelMat = glm::translate(modelMat, newPosition);
-
-                // Supongamos que la posición de la cabeza está en headOffset respecto al centro del modelo
-                glm::vec3 headOffset = glm::vec3(0.0f, 0.0f, -300.0f); // ejemplo: 1.8 unidades arriba del centro del cuerpo
-
-                // Desplazar el modelo de manera que la cabeza esté en el origen
-                modelMat = glm::translate(modelMat, -headOffset);
-
-                // Aplicar la rotación alrededor del eje Y desde la posición de la cabeza
-                float zOffset = 100.0f * sin(glfwGetTime() * 20.0f);
-                float tiltAngleZ = glm::radians(zOffset / 200.0f * 15.0f); // 15 grados es el ángulo máximo de giro en Z
-                modelMat = glm::rotate(modelMat, tiltAngleZ, glm::vec3(0.0f, 1.0f, 0.0f));
-
-                // Desplazar el modelo de regreso a su posición original
-                modelMat = glm::translate(modelMat, headOffset);
+                updateWaveModel(model, currentTime);
 
             }
 
 
-
-
-
-            if (model.ModelName == "Models/finalcube.obj" || model.ModelName == "Models/superficie2.obj") {
-                glEnable(GL_BLEND);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            // Fuera de la vista no se dibuja; el agua se salta la prueba porque la ola mueve sus vértices fuera de los límites de carga
+            bool visible = model.isWater || camera.frustum.Intersects(model.bounds, modelMat);
+
+            // La cola sube la matriz de cada modelo justo antes de su dibujo
+            DrawCommand draw;
+            draw.shader = shaderProgram.ID;
+            draw.texture = model.texture.ID;
+            draw.vao = model.vao.ID;
+            draw.indexCount = model.indexCount;
+            draw.model = modelMat;
+            draw.normal = entities.normalMatrices[e];
+            SceneUniforms* uniforms = &modelUniforms;
+            if (model.isWater && gpuWaves) {
+                draw.shader = waterProgram.ID;
+                uniforms = &waterUniforms;
+            } else if (model.isWater && waveEngine) {
+                draw.shader = waterHeightsProgram.ID;
+                uniforms = &waterHeightsUniforms;
             }
-
-
-            float currentTime = glfwGetTime();
-            if (model.ModelName == "Models/superficie2.obj") {
-
-                updateWaveModel(model, currentTime);
-
+            draw.modelUniform = &uniforms->model;
+            draw.normalUniform = &uniforms->normalMatrix;
+            if (visible) {
+                renderQueue.Submit(draw, model.transparent, glm::distance(camera.Position, glm::vec3(modelMat[3])));
             }
 
+        }
 
+        // El reloj de la ola se sube una vez por frame, el resto lo calcula water.vert
+        if (gpuWaves) {
+            waterProgram.Activate();
+            waterTime.Set(frameTime);
+        }
+        // Lo mismo para los peces: el costo en la CPU no depende de cuántos haya
+        if (gpuFish) {
+            fishProgram.Activate();
+            fishTime.Set(angleV2);
+        }
 
+        renderQueue.Execute();
 
-
-
-
-
-
-            model.texture.Bind();
-            // Bind the VAO so OpenGL knows to use it
-
-            model.vao.Bind();
-
-            // Draw primitives, number of indices, datatype of indices, index of indices
-            glDrawElements(GL_TRIANGLES, model.indices.size(), GL_UNSIGNED_INT, 0);
-            i++;
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram.ID, "model"), 1, GL_FALSE, glm::value_ptr(modelMat));
-            glUniform4f(glGetUniformLocation(shaderProgram.ID, "lightColor"), lightColor.x, lightColor.y, lightColor.z, lightColor.w);
-            glUniform3f(glGetUniformLocation(shaderProgram.ID, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
-
+        // La región de alturas de este frame queda ocupada hasta que la GPU termine de dibujar el agua
+        if (waveEngine) {
+            waveEngine->Fence();
         }
 
 
@@ -725,47 +1435,72 @@ int main()
 
 
         glBindVertexArray(0);
-        // Swap the back buffer with the front buffer
-        glfwSwapBuffers(window);
-        // Take care of all GLFW events
-        glfwPollEvents();
+        if (measured) {
+            gpuTimer->End();
+        }
+        if (window) {
+            PROFILE_SCOPE("glfwSwapBuffers");
+            // Swap the back buffer with the front buffer
+            glfwSwapBuffers(window);
+            // Take care of all GLFW events
+            glfwPollEvents();
+        }
+        if (measured) {
+            frameStats.cpu.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+            frameStats.drawCalls.push_back(renderQueue.stats.drawCalls);
+            frameStats.triangles.push_back(renderQueue.stats.triangles);
+        }
+        frameCount++;
     }
 
-    // Delete window before ending the program
-    glfwDestroyWindow(window);
-    // Terminate GLFW before ending the program
-    glfwTerminate();
-    return 0;
-}
-
-int con = 0;
-
-Model loadModel(const std::string& objFilePath, const std::string& texturePath, bool isPNG ,Shader& shaderProgram, GLuint i) {
-    std::vector<Vertex> vertices;
-    std::vector<GLuint> indices;
-
-    if (!loadObj(objFilePath, vertices, indices)) {
-        std::cerr << "Error loading OBJ file: " << objFilePath << std::endl;
+    // Los hilos del pool ya no tienen tareas, así que la traza se puede leer entera
+    if (!options.profilePath.empty()) {
+        if (Profiler::WriteChromeTrace(options.profilePath)) {
+            std::cout << "Wrote profile trace to " << options.profilePath << std::endl;
+        } else {
+            std::cerr << "Could not write profile trace: " << options.profilePath << std::endl;
+        }
     }
 
-    if (isPNG) {
-        Texture Tex(texturePath.c_str(), GL_TEXTURE_2D, GL_TEXTURE0, GL_RGBA, GL_UNSIGNED_BYTE);
-        Tex.texUnit(shaderProgram, "tex0", i);
-        Model model(vertices, indices, objFilePath, Tex);
-        return model;
-    } else {
-        Texture Tex(texturePath.c_str(), GL_TEXTURE_2D, GL_TEXTURE0, GL_RGB, GL_UNSIGNED_BYTE);
-        Tex.texUnit(shaderProgram, "tex0", i);
-        Model model(vertices, indices, objFilePath, Tex);
-        return model;
+    if (benchmark) {
+        gpuTimer->Flush();
+        frameStats.gpu = gpuTimer->results;
+        gpuTimer->Delete();
+
+        FrameTimeSummary cpuSummary = FrameStats::Summarize(frameStats.cpu);
+        FrameTimeSummary gpuSummary = FrameStats::Summarize(frameStats.gpu);
+        std::cout << "Benchmark: " << frameStats.cpu.size() << " frames, CPU avg " << cpuSummary.avg << " ms p99 " << cpuSummary.p99
+                  << " ms, GPU avg " << gpuSummary.avg << " ms p99 " << gpuSummary.p99 << " ms" << std::endl;
+        // Lo que realmente se colocó, que con cantidades grandes puede ser menos de lo pedido
+        BenchmarkInfo info;
+        info.width = options.width;
+        info.height = options.height;
+        for (uint32_t e = 0; e < scene.EntityCount(); e++) {
+            uint32_t group = scene.assets[scene.entities[e].asset].group;
+            info.fish += group == GROUP_FISH;
+            info.rocks += group == GROUP_ROCK;
+            info.corals += group == GROUP_CORAL;
+        }
+        if (!options.reportPath.empty() && !frameStats.WriteReport(options.reportPath, info)) {
+            std::cerr << "Could not write benchmark report: " << options.reportPath << std::endl;
+        }
     }
 
+    if (!window) {
+        glFinish();
+        std::cout << "Rendered " << frameCount << " frames at " << options.width << "x" << options.height << " in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() << " s" << std::endl;
+        if (!options.outputPath.empty()) {
+            std::vector<unsigned char> pixels;
+            offscreen->ReadPixels(pixels);
+            if (!writePPM(options.outputPath, pixels, options.width, options.height)) {
+                std::cerr << "Could not write frame: " << options.outputPath << std::endl;
+            }
+        }
+    }
 
-
-
-    con++;
-
-
+    // Delete the window or the offscreen context before ending the program
+    shutdown();
+    return 0;
 }
-
-
+#endif
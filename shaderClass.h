@@ -7,9 +7,25 @@
 #include<sstream>
 #include<iostream>
 #include<cerrno>
+#include<unordered_map>
+
+#include"Profiler.h"
 
 std::string get_file_contents(const char* filename);
 
+// Uniform block with the per-frame camera and light data, shared by every program
+const char* const frameBlockName = "Frame";
+const GLuint frameBlockBinding = 0;
+
+// CPU side of the "Frame" block (std140: every member is 16 byte aligned, vec3s are sent as vec4)
+struct FrameBlock
+{
+	glm::mat4 camMatrix;
+	glm::vec4 camPos;
+	glm::vec4 lightColor;
+	glm::vec4 lightPos;
+};
+
 class Shader
 {
 public:
@@ -22,9 +38,34 @@ public:
 	void Activate();
 	// Deletes the Shader Program
 	void Delete();
+	// Returns the cached location of an active uniform (-1 if the program doesn't use it)
+	GLint GetUniformLocation(const std::string& name) const;
 private:
+	// Locations of every active uniform, queried once after linking
+	std::unordered_map<std::string, GLint> uniformLocations;
+
 	// Checks if the different Shaders have compiled properly
 	void compileErrors(unsigned int shader, const char* type);
+	// Fills uniformLocations with the active uniforms of the linked program
+	void queryUniforms();
+};
+
+
+// Handle to a uniform of a Shader that keeps its location and skips uploads of an unchanged value.
+// Create one handle per uniform and only call Set while its Shader is active.
+template<typename T>
+class Uniform
+{
+public:
+	Uniform() {}
+	Uniform(const Shader& shader, const std::string& name);
+
+	// Uploads the value to the active Shader if it differs from the last one sent
+	void Set(const T& value);
+private:
+	GLint location = -1;
+	bool hasValue = false;
+	T lastValue;
 };
 
 
@@ -65,6 +106,7 @@ std::string get_file_contents(const char* filename)
 // Constructor that build the Shader Program from 2 different shaders
 Shader::Shader(const char* vertexFile, const char* fragmentFile)
 {	
+	PROFILE_SCOPE("Shader compile");
 
 	// Read vertexFile and fragmentFile and store the strings
 	std::string vertexCode = get_file_contents(vertexFile);
@@ -109,6 +151,13 @@ Shader::Shader(const char* vertexFile, const char* fragmentFile)
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
 
+	// Caches the uniform locations so the render loop never asks the driver by name
+	queryUniforms();
+
+	// Links the per-frame uniform block (if the program uses it) to its fixed binding point
+	GLuint frameBlock = glGetUniformBlockIndex(ID, frameBlockName);
+	if (frameBlock != GL_INVALID_INDEX)
+		glUniformBlockBinding(ID, frameBlock, frameBlockBinding);
 }
 
 // Activates the Shader Program
@@ -123,6 +172,39 @@ void Shader::Delete()
 	glDeleteProgram(ID);
 }
 
+// Returns the cached location of an active uniform (-1 if the program doesn't use it)
+GLint Shader::GetUniformLocation(const std::string& name) const
+{
+	auto found = uniformLocations.find(name);
+	return found == uniformLocations.end() ? -1 : found->second;
+}
+
+// Fills uniformLocations with the active uniforms of the linked program
+void Shader::queryUniforms()
+{
+	GLint count = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		char name[256];
+		GLsizei length;
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(ID, i, sizeof(name), &length, &size, &type, name);
+
+		// Uniforms inside a uniform block have no location of their own
+		GLint location = glGetUniformLocation(ID, name);
+		if (location < 0)
+			continue;
+
+		// Arrays are reported as "name[0]", also make them reachable as "name"
+		std::string uniformName(name, length);
+		uniformLocations[uniformName] = location;
+		if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+			uniformLocations[uniformName.substr(0, uniformName.size() - 3)] = location;
+	}
+}
+
 // Checks if the different Shaders have compiled properly
 void Shader::compileErrors(unsigned int shader, const char* type)
 {
@@ -151,4 +233,30 @@ void Shader::compileErrors(unsigned int shader, const char* type)
 }
 
 
+// Uploads a value to a uniform location of the active program
+inline void uploadUniform(GLint location, GLint value) { glUniform1i(location, value); }
+inline void uploadUniform(GLint location, GLfloat value) { glUniform1f(location, value); }
+inline void uploadUniform(GLint location, const glm::vec3& value) { glUniform3f(location, value.x, value.y, value.z); }
+inline void uploadUniform(GLint location, const glm::vec4& value) { glUniform4f(location, value.x, value.y, value.z, value.w); }
+inline void uploadUniform(GLint location, const glm::mat3& value) { glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+inline void uploadUniform(GLint location, const glm::mat4& value) { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+
+template<typename T>
+Uniform<T>::Uniform(const Shader& shader, const std::string& name)
+{
+	location = shader.GetUniformLocation(name);
+}
+
+// Uploads the value to the active Shader if it differs from the last one sent
+template<typename T>
+void Uniform<T>::Set(const T& value)
+{
+	if (location < 0 || (hasValue && lastValue == value))
+		return;
+	uploadUniform(location, value);
+	lastValue = value;
+	hasValue = true;
+}
+
+
 #endif
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Barrido de tamaños de escena: corre el visor sin ventana con el recorrido del benchmark para cada
+# combinación de peces, rocas y resolución, y junta una fila por corrida en un solo CSV
+# (tiempos de CPU y GPU, draw calls, triángulos y memoria pico).
+#
+# Uso: ./sweep.sh            (las listas se cambian con variables de entorno)
+#   BIN=./main FISH="10 1000" ROCKS="100 10000" SIZES="1280x720" FRAMES=120 OUT=sweep.csv ./sweep.sh
+# Sin FRAMES cada corrida mide el recorrido completo (750 frames de 1/60 s para flythrough.path).
+#
+# La resolución es el bucle de adentro: las corridas con los mismos peces y rocas reusan la instantánea
+# de la escena y solo la primera paga la colocación.
+
+BIN=${BIN:-./main}
+FISH=${FISH:-"10 100 1000 10000 100000"}
+ROCKS=${ROCKS:-"100 1000 10000 100000 1000000"}
+SIZES=${SIZES:-"1280x720 1920x1080 2560x1440 3840x2160"}
+FRAMES=${FRAMES:-}
+CAMERA_PATH=${CAMERA_PATH:-flythrough.path}
+OUT=${OUT:-sweep.csv}
+
+frameArgs=""
+if [ -n "$FRAMES" ]; then
+    frameArgs="--frames $FRAMES"
+fi
+
+report=$(mktemp /tmp/sweep.XXXXXX)
+report="$report.csv"
+trap 'rm -f "$report" "${report%.csv}"' EXIT
+
+rm -f "$OUT"
+for fish in $FISH; do
+    for rocks in $ROCKS; do
+        for size in $SIZES; do
+            echo "fish=$fish rocks=$rocks size=$size"
+            rm -f "$report"
+            if ! "$BIN" --headless --size "$size" $frameArgs --camera-path "$CAMERA_PATH" \
+                    --fish "$fish" --rocks "$rocks" --report "$report"; then
+                echo "Run failed: fish=$fish rocks=$rocks size=$size" >&2
+                continue
+            fi
+            # La cabecera una sola vez, después solo las filas
+            if [ ! -f "$OUT" ]; then
+                head -n 1 "$report" > "$OUT"
+            fi
+            tail -n +2 "$report" >> "$OUT"
+        done
+    done
+done
+
+echo "Wrote $OUT"
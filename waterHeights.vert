@@ -0,0 +1,54 @@
+#version 330 core
+
+// Positions/Coordinates
+layout (location = 0) in vec3 aPos;
+// Colors
+layout (location = 1) in vec3 aColor;
+// Texture Coordinates
+layout (location = 2) in vec2 aTex;
+// Normals (not necessarily normalized)
+layout (location = 3) in vec3 aNormal;
+// Height of the water surface, simulated on the CPU by WaveEngine
+layout (location = 4) in float aHeight;
+
+
+// Outputs the color for the Fragment Shader
+out vec3 color;
+// Outputs the texture coordinates to the Fragment Shader
+out vec2 texCoord;
+// Outputs the normal for the Fragment Shader
+out vec3 Normal;
+// Outputs the current position for the Fragment Shader
+out vec3 crntPos;
+
+// Per-frame camera and light data, written once per frame by the main function
+layout (std140) uniform Frame
+{
+	mat4 camMatrix;
+	vec4 camPos;
+	vec4 lightColor;
+	vec4 lightPos;
+};
+// Imports the model matrix from the main function
+uniform mat4 model;
+// Imports the normal matrix (inverse transpose of the model matrix) from the main function
+uniform mat3 normalMatrix;
+
+
+void main()
+{
+	// Takes the height from its own stream, x and z stay the ones of the mesh
+	vec3 position = vec3(aPos.x, aHeight, aPos.z);
+
+	// calculates current position
+	crntPos = vec3(model * vec4(position, 1.0f));
+	// Outputs the positions/coordinates of all vertices
+	gl_Position = camMatrix * vec4(crntPos, 1.0);
+
+	// Assigns the colors from the Vertex Data to "color"
+	color = aColor;
+	// Assigns the texture coordinates from the Vertex Data to "texCoord"
+	texCoord = aTex;
+	// Rotates the normal from the Vertex Data into world space
+	Normal = normalMatrix * aNormal;
+}